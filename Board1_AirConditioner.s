@@ -45,6 +45,23 @@ PSECT udata_bank0
     w_temp:             DS 1    ; Context saving for ISR
     status_temp:        DS 1
 
+    ; UART Command Handling
+    desired_frac:       DS 1    ; Desired Temp fractional part (Set by host)
+    rx_byte:            DS 1    ; Last received command byte
+    rx_state:           DS 1    ; 0x0A while waiting for a delta ack byte
+
+    ; Delta Telemetry (0x0A / 0x0B)
+    tx_seq:             DS 1    ; Sequence number of the last delta sent
+    delta_map:          DS 1    ; Changed-field bitmap being sent
+    ack_desired:        DS 1    ; Values the host has acknowledged
+    ack_ambient:        DS 1
+    ack_fan:            DS 1
+    ack_frac:           DS 1
+    sent_desired:       DS 1    ; Values in the last delta sent
+    sent_ambient:       DS 1
+    sent_fan:           DS 1
+    sent_frac:          DS 1
+
 ; ============================================================================
 ; RESET VECTOR
 ; ============================================================================
@@ -61,6 +78,10 @@ ISR:
     MOVWF   w_temp
     SWAPF   STATUS, W
     MOVWF   status_temp
+    BANKSEL fsr_temp
+    MOVF    FSR, W
+    MOVWF   fsr_temp
+    BCF     STATUS, 7       ; IRP = 0: FSR buffers live in Banks 0/1
 
     ; Check Timer0 Interrupt (For 7-Segment Multiplexing)
     BANKSEL INTCON
@@ -69,18 +90,9 @@ ISR:
 
     CALL    Refresh_Display
     BCF     INTCON, 2       ; Clear T0IF
+    CALL    Link_Tick       ; UART link timeout (uart_link.inc)
 
-Check_UART:
-    ; UART Handling (Placeholder for R2.1.4-1)
-    ; Check PIR1, RCIF here for serial commands
-    
-Exit_ISR:
-    ; Context Restore
-    SWAPF   status_temp, W
-    MOVWF   STATUS
-    SWAPF   w_temp, F
-    SWAPF   w_temp, W
-    RETFIE
+#include "uart_link_isr.inc"
 
 ; ============================================================================
 ; MAIN PROGRAM
@@ -96,6 +108,20 @@ Main:
     MOVLW   25              ; Default desired temp = 25 degrees (approx)
     MOVWF   desired_temp
     CLRF    digit_counter
+    CLRF    desired_frac
+    CLRF    rx_state
+    CLRF    tx_seq
+    CLRF    ack_desired
+    CLRF    ack_ambient
+    CLRF    ack_fan
+    CLRF    ack_frac
+    CLRF    link_flags      ; Raw (legacy) protocol until the first valid frame
+    CLRF    cobs_count
+    CLRF    rx_len
+    CLRF    raw_len
+    CLRF    tx_head
+    CLRF    tx_tail
+    BSF     INTCON, 7       ; Enable GIE (last: ISR assumes Bank 0)
 
 Main_Loop:
     ; ---------------------------------------------------------
@@ -214,8 +240,7 @@ Setup_Timer0:
     MOVWF   OPTION_REG
     
     BANKSEL INTCON
-    BSF     INTCON, 5       ; Enable T0IE
-    BSF     INTCON, 7       ; Enable GIE
+    BSF     INTCON, 5       ; Enable T0IE (GIE is set at the end of Main init)
     RETURN
 
 ; --- Setup UART ---
@@ -231,6 +256,11 @@ Setup_UART:
     BANKSEL RCSTA
     BSF     RCSTA, 7        ; SPEN = 1
     BSF     RCSTA, 4        ; CREN = 1
+
+    BANKSEL PIE1
+    BSF     PIE1, 5         ; Enable RCIE (TXIE is set while data is queued)
+    BANKSEL INTCON
+    BSF     INTCON, 6       ; Enable PEIE
     RETURN
 
 ; --- Refresh Display (Called from ISR) ---
@@ -323,4 +353,160 @@ Hex_To_7Seg:
     RETLW   0x79 ; E
     RETLW   0x71 ; F
 
+; ============================================================================
+; UART PROTOCOL
+; (Kept after the lookup tables so their ADDWF PCL jumps stay in the first
+;  256 words with PCLATH = 0)
+; ============================================================================
+
+#include "uart_link.inc"
+
+; --- UART Command Dispatcher (Called from ISR, byte in rx_byte) ---
+; Get:   0x01 Desired Frac, 0x02 Desired Int, 0x03 Ambient Frac,
+;        0x04 Ambient Int,  0x05 Fan Speed
+; Set:   10xxxxxx Desired Frac, 11xxxxxx Desired Int
+; Delta: 0x0A <ack seq> -> changed fields only, 0x0B -> full resync
+UART_Command:
+    MOVF    rx_state, W
+    BTFSS   STATUS, 2       ; Waiting for the ack byte of a 0x0A request?
+    GOTO    Delta_Request
+    BTFSC   rx_byte, 7      ; 1xxxxxxx = Set command
+    GOTO    Set_Command
+
+    MOVF    rx_byte, W
+    XORLW   0x01
+    BTFSC   STATUS, 2
+    GOTO    Get_Desired_Frac
+    XORLW   0x03            ; 0x01 ^ 0x02
+    BTFSC   STATUS, 2
+    GOTO    Get_Desired_Int
+    XORLW   0x01            ; 0x02 ^ 0x03
+    BTFSC   STATUS, 2
+    GOTO    Get_Ambient_Frac
+    XORLW   0x07            ; 0x03 ^ 0x04
+    BTFSC   STATUS, 2
+    GOTO    Get_Ambient_Int
+    XORLW   0x01            ; 0x04 ^ 0x05
+    BTFSC   STATUS, 2
+    GOTO    Get_Fan_Speed
+    XORLW   0x0F            ; 0x05 ^ 0x0A
+    BTFSC   STATUS, 2
+    GOTO    Delta_Begin
+    XORLW   0x01            ; 0x0A ^ 0x0B
+    BTFSC   STATUS, 2
+    GOTO    Delta_Resync
+    RETURN                  ; Unknown command: ignore
+
+Get_Desired_Frac:
+    MOVF    desired_frac, W
+    GOTO    UART_Send
+Get_Desired_Int:
+    MOVF    desired_temp, W
+    GOTO    UART_Send
+Get_Ambient_Frac:
+    MOVLW   0               ; 8-bit ADC reading, no fractional part
+    GOTO    UART_Send
+Get_Ambient_Int:
+    MOVF    current_temp, W
+    GOTO    UART_Send
+Get_Fan_Speed:
+    MOVF    fan_speed, W
+    GOTO    UART_Send
+
+Set_Command:
+    MOVF    rx_byte, W
+    ANDLW   0x3F
+    BTFSS   rx_byte, 6      ; 11xxxxxx = Integer, 10xxxxxx = Fraction
+    GOTO    Set_Frac
+    MOVWF   desired_temp
+    RETURN
+Set_Frac:
+    MOVWF   desired_frac
+    RETURN
+
+; --- Delta Telemetry ---
+; Reply: [seq] [bitmap] [value per set bit, bit 0 first]
+;   bit 0 = Desired Int, bit 1 = Ambient Int, bit 2 = Fan Speed,
+;   bit 3 = Desired Frac
+; Changes are computed against the last values the host acknowledged, so
+; a lost reply is simply resent; the host resyncs (0x0B) on a seq gap.
+; Seq runs 1..255, never 0x00, so raw-mode acks stay delimiter-free.
+Delta_Begin:
+    MOVLW   0x0A
+    MOVWF   rx_state        ; Next byte is the host's ack sequence
+    RETURN
+
+Delta_Request:
+    CLRF    rx_state
+    MOVF    rx_byte, W
+    XORWF   tx_seq, W
+    BTFSS   STATUS, 2       ; Host acked the last delta we sent?
+    GOTO    Delta_Build     ; No: keep the old reference
+    MOVF    sent_desired, W ; Yes: host now holds the sent values
+    MOVWF   ack_desired
+    MOVF    sent_ambient, W
+    MOVWF   ack_ambient
+    MOVF    sent_fan, W
+    MOVWF   ack_fan
+    MOVF    sent_frac, W
+    MOVWF   ack_frac
+Delta_Build:
+    CALL    Delta_Snapshot
+    CLRF    delta_map
+    MOVF    sent_desired, W
+    XORWF   ack_desired, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 0
+    MOVF    sent_ambient, W
+    XORWF   ack_ambient, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 1
+    MOVF    sent_fan, W
+    XORWF   ack_fan, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 2
+    MOVF    sent_frac, W
+    XORWF   ack_frac, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 3
+    GOTO    Delta_Send
+
+Delta_Resync:
+    CALL    Delta_Snapshot
+    MOVLW   00001111B       ; All fields
+    MOVWF   delta_map
+
+Delta_Send:
+    INCF    tx_seq, F
+    BTFSC   STATUS, 2       ; Skip seq 0: the raw ack byte that echoes it
+    INCF    tx_seq, F       ; must never look like a frame delimiter
+    MOVF    tx_seq, W
+    CALL    UART_Send
+    MOVF    delta_map, W
+    CALL    UART_Send
+    MOVF    sent_desired, W
+    BTFSC   delta_map, 0
+    CALL    UART_Send
+    MOVF    sent_ambient, W
+    BTFSC   delta_map, 1
+    CALL    UART_Send
+    MOVF    sent_fan, W
+    BTFSC   delta_map, 2
+    CALL    UART_Send
+    MOVF    sent_frac, W
+    BTFSC   delta_map, 3
+    CALL    UART_Send
+    RETURN
+
+Delta_Snapshot:
+    MOVF    desired_temp, W
+    MOVWF   sent_desired
+    MOVF    current_temp, W
+    MOVWF   sent_ambient
+    MOVF    fan_speed, W
+    MOVWF   sent_fan
+    MOVF    desired_frac, W
+    MOVWF   sent_frac
+    RETURN
+
     END
\ No newline at end of file
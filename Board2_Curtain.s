@@ -19,6 +19,12 @@ PSECT udata_bank0
     curtain_desired:    DS 1    ; [cite: 689]
     light_val:          DS 1    ; LDR Value [cite: 695]
     pot_val:            DS 1    ; Potentiometer Value
+    adc_delay:          DS 1    ; Acquisition delay counter (Read_ADC)
+
+    ; Host Control (UART set command)
+    host_override:      DS 1    ; Bit 0: host setpoint holds until the pot moves
+    host_desired:       DS 1    ; Curtain value from the last set command
+    pot_at_set:         DS 1    ; Pot reading when the set arrived
     
     ; Stepper Logic
     step_index:         DS 1    ; Index in step sequence (0-3)
@@ -27,6 +33,30 @@ PSECT udata_bank0
     ; LCD Vars
     lcd_temp:           DS 1
 
+    ; BMP180 readings (driver pending, reported as 0 until then)
+    outdoor_temp:       DS 1
+    pressure_val:       DS 1
+
+    ; UART Command Handling
+    rx_byte:            DS 1    ; Last received command byte
+    rx_state:           DS 1    ; 0x0A while waiting for a delta ack byte
+
+    ; Delta Telemetry (0x0A / 0x0B)
+    tx_seq:             DS 1    ; Sequence number of the last delta sent
+    delta_map:          DS 1    ; Changed-field bitmap being sent
+    ack_curtain:        DS 1    ; Values the host has acknowledged
+    ack_outdoor:        DS 1
+    ack_pressure:       DS 1
+    ack_light:          DS 1
+    sent_curtain:       DS 1    ; Values in the last delta sent
+    sent_outdoor:       DS 1
+    sent_pressure:      DS 1
+    sent_light:         DS 1
+
+    ; ISR Context
+    w_temp:             DS 1
+    status_temp:        DS 1
+
 ; ============================================================================
 ; RESET VECTOR
 ; ============================================================================
@@ -34,12 +64,36 @@ PSECT code, delta=2
 ORG 0x0000
     GOTO    Main
 
+; ============================================================================
+; INTERRUPT VECTOR (UART + link timeout tick)
+; ============================================================================
+ORG 0x0004
+ISR:
+    ; Context Save
+    MOVWF   w_temp
+    SWAPF   STATUS, W
+    MOVWF   status_temp
+    BANKSEL fsr_temp
+    MOVF    FSR, W
+    MOVWF   fsr_temp
+    BCF     STATUS, 7       ; IRP = 0: FSR buffers live in Banks 0/1
+
+    ; Timer0: UART link timeout tick
+    BANKSEL INTCON
+    BTFSS   INTCON, 2       ; Check T0IF
+    GOTO    Check_UART
+    BCF     INTCON, 2       ; Clear T0IF
+    CALL    Link_Tick
+
+#include "uart_link_isr.inc"
+
 ; ============================================================================
 ; MAIN PROGRAM
 ; ============================================================================
 Main:
     CALL    Setup_Ports
     CALL    Setup_ADC
+    CALL    Setup_Timer0
     CALL    Setup_UART
     CALL    LCD_Init
     
@@ -47,6 +101,23 @@ Main:
     CLRF    curtain_current ; Start Open (0%)
     CLRF    curtain_desired
     CLRF    step_index
+    CLRF    host_override
+    CLRF    outdoor_temp
+    CLRF    pressure_val
+    CLRF    rx_state
+    CLRF    tx_seq
+    CLRF    ack_curtain
+    CLRF    ack_outdoor
+    CLRF    ack_pressure
+    CLRF    ack_light
+    CLRF    link_flags      ; Raw (legacy) protocol until the first valid frame
+    CLRF    cobs_count
+    CLRF    rx_len
+    CLRF    raw_len
+    CLRF    tx_head
+    CLRF    tx_tail
+    BANKSEL INTCON
+    BSF     INTCON, 7       ; Enable GIE (last: ISR assumes Bank 0)
 
 Main_Loop:
     ; --------------------------------------------------------
@@ -58,6 +129,24 @@ Main_Loop:
     ; Approx: ADC / 2.5. For assembly, roughly (ADC * 10) / 25
     ; Simplified: Just use High Byte scaled.
     MOVWF   pot_val
+
+    ; Host override: a set command holds the curtain (also against night
+    ; mode) until the pot is turned more than 4 counts from where it was
+    BTFSS   host_override, 0
+    GOTO    Use_Pot
+    MOVF    pot_at_set, W
+    SUBWF   pot_val, W      ; W = pot - pot_at_set
+    ADDLW   4
+    SUBLW   8               ; C = (-4 <= diff <= 4)
+    BTFSS   STATUS, 0
+    GOTO    Release_Override
+    MOVF    host_desired, W
+    MOVWF   curtain_desired
+    GOTO    Read_Light
+Release_Override:
+    BCF     host_override, 0 ; Pot moved: back to local control
+
+Use_Pot:
     ; Simple mapping for demo: Use ADC value directly as desired % (limit to 100)
     MOVLW   100
     SUBWF   pot_val, W
@@ -67,6 +156,14 @@ Main_Loop:
     MOVF    pot_val, W
     MOVWF   curtain_desired
 
+Read_Light:
+    ; Analog LDR level (AN1) for telemetry
+    MOVLW   00001000B       ; Channel 1 (RA1)
+    CALL    Read_ADC
+    MOVWF   light_val
+    BTFSC   host_override, 0 ; Host setpoint wins over night mode
+    GOTO    Check_Movement
+
     ; --------------------------------------------------------
     ; 2. Read LDR (Light Sensor) [cite: 696]
     ; --------------------------------------------------------
@@ -147,11 +244,16 @@ D_Loop: DECFSZ 0x70, F
     GOTO    D_Loop
     RETURN
 
-; --- ADC Driver ---
+; --- ADC Driver (W = channel bits CHS2:CHS0 << 3) ---
 Read_ADC:
     BANKSEL ADCON0
+    IORLW   01000001B       ; Fosc/8 (TAD = 2 us at 4 MHz, min 1.6 us), ADON
     MOVWF   ADCON0          ; Select Channel
-    BSF     ADCON0, 0       ; ADON
+    MOVLW   7               ; Acquisition time after the channel switch (~20 us)
+    MOVWF   adc_delay
+ADC_Acquire:
+    DECFSZ  adc_delay, F
+    GOTO    ADC_Acquire
     BSF     ADCON0, 2       ; GO
 Wait_ADC:
     BTFSC   ADCON0, 2
@@ -187,6 +289,17 @@ Setup_ADC:
     MOVWF   ADCON0
     RETURN
 
+; --- Setup Timer0 (UART link timeout tick, ~16 ms) ---
+Setup_Timer0:
+    BANKSEL OPTION_REG
+    ; Prescaler 1:64 assigned to TMR0
+    MOVLW   11010101B       ; T0CS=0, PSA=0, PS=101
+    MOVWF   OPTION_REG
+
+    BANKSEL INTCON
+    BSF     INTCON, 5       ; Enable T0IE (GIE is set at the end of Main init)
+    RETURN
+
 Setup_UART:
     ; [cite: 335] Standard 9600 Baud
     BANKSEL SPBRG
@@ -197,6 +310,161 @@ Setup_UART:
     BANKSEL RCSTA
     BSF     RCSTA, 7        ; SPEN
     BSF     RCSTA, 4        ; CREN
+
+    BANKSEL PIE1
+    BSF     PIE1, 5         ; Enable RCIE (TXIE is set while data is queued)
+    BANKSEL INTCON
+    BSF     INTCON, 6       ; Enable PEIE
+    RETURN
+
+#include "uart_link.inc"
+
+; --- UART Command Dispatcher (Called from ISR, byte in rx_byte) [cite: 719] ---
+; Get:   0x01/0x02 Curtain Frac/Int, 0x03/0x04 Outdoor Temp Frac/Int,
+;        0x05/0x06 Pressure Frac/Int, 0x07/0x08 Light Frac/Int
+; Set:   10xxxxxx Curtain Frac, 11xxxxxx Curtain Int
+; Delta: 0x0A <ack seq> -> changed fields only, 0x0B -> full resync
+UART_Command:
+    MOVF    rx_state, W
+    BTFSS   STATUS, 2       ; Waiting for the ack byte of a 0x0A request?
+    GOTO    Delta_Request
+    BTFSC   rx_byte, 7      ; 1xxxxxxx = Set command
+    GOTO    Set_Command
+
+    MOVF    rx_byte, W
+    XORLW   0x02
+    BTFSC   STATUS, 2
+    GOTO    Get_Curtain
+    XORLW   0x06            ; 0x02 ^ 0x04
+    BTFSC   STATUS, 2
+    GOTO    Get_Outdoor
+    XORLW   0x02            ; 0x04 ^ 0x06
+    BTFSC   STATUS, 2
+    GOTO    Get_Pressure
+    XORLW   0x0E            ; 0x06 ^ 0x08
+    BTFSC   STATUS, 2
+    GOTO    Get_Light
+    XORLW   0x02            ; 0x08 ^ 0x0A
+    BTFSC   STATUS, 2
+    GOTO    Delta_Begin
+    XORLW   0x01            ; 0x0A ^ 0x0B
+    BTFSC   STATUS, 2
+    GOTO    Delta_Resync
+    ; 0x01/0x03/0x05/0x07: fractional parts are not measured yet
+    MOVF    rx_byte, W
+    SUBLW   0x07
+    BTFSS   STATUS, 0       ; Command > 0x07: unknown, ignore
+    RETURN
+    MOVLW   0
+    GOTO    UART_Send
+
+Get_Curtain:
+    MOVF    curtain_current, W
+    GOTO    UART_Send
+Get_Outdoor:
+    MOVF    outdoor_temp, W
+    GOTO    UART_Send
+Get_Pressure:
+    MOVF    pressure_val, W
+    GOTO    UART_Send
+Get_Light:
+    MOVF    light_val, W
+    GOTO    UART_Send
+
+Set_Command:
+    BTFSS   rx_byte, 6      ; 10xxxxxx fraction: not used by the stepper
+    RETURN
+    MOVF    rx_byte, W
+    ANDLW   0x3F
+    MOVWF   host_desired
+    MOVWF   curtain_desired
+    MOVF    pot_val, W      ; Pot position the override is measured from
+    MOVWF   pot_at_set
+    BSF     host_override, 0
+    RETURN
+
+; --- Delta Telemetry ---
+; Reply: [seq] [bitmap] [value per set bit, bit 0 first]
+;   bit 0 = Curtain, bit 1 = Outdoor Temp, bit 2 = Pressure, bit 3 = Light
+; Changes are computed against the last values the host acknowledged, so
+; a lost reply is simply resent; the host resyncs (0x0B) on a seq gap.
+; Seq runs 1..255, never 0x00, so raw-mode acks stay delimiter-free.
+Delta_Begin:
+    MOVLW   0x0A
+    MOVWF   rx_state        ; Next byte is the host's ack sequence
+    RETURN
+
+Delta_Request:
+    CLRF    rx_state
+    MOVF    rx_byte, W
+    XORWF   tx_seq, W
+    BTFSS   STATUS, 2       ; Host acked the last delta we sent?
+    GOTO    Delta_Build     ; No: keep the old reference
+    MOVF    sent_curtain, W ; Yes: host now holds the sent values
+    MOVWF   ack_curtain
+    MOVF    sent_outdoor, W
+    MOVWF   ack_outdoor
+    MOVF    sent_pressure, W
+    MOVWF   ack_pressure
+    MOVF    sent_light, W
+    MOVWF   ack_light
+Delta_Build:
+    CALL    Delta_Snapshot
+    CLRF    delta_map
+    MOVF    sent_curtain, W
+    XORWF   ack_curtain, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 0
+    MOVF    sent_outdoor, W
+    XORWF   ack_outdoor, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 1
+    MOVF    sent_pressure, W
+    XORWF   ack_pressure, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 2
+    MOVF    sent_light, W
+    XORWF   ack_light, W
+    BTFSS   STATUS, 2
+    BSF     delta_map, 3
+    GOTO    Delta_Send
+
+Delta_Resync:
+    CALL    Delta_Snapshot
+    MOVLW   00001111B       ; All fields
+    MOVWF   delta_map
+
+Delta_Send:
+    INCF    tx_seq, F
+    BTFSC   STATUS, 2       ; Skip seq 0: the raw ack byte that echoes it
+    INCF    tx_seq, F       ; must never look like a frame delimiter
+    MOVF    tx_seq, W
+    CALL    UART_Send
+    MOVF    delta_map, W
+    CALL    UART_Send
+    MOVF    sent_curtain, W
+    BTFSC   delta_map, 0
+    CALL    UART_Send
+    MOVF    sent_outdoor, W
+    BTFSC   delta_map, 1
+    CALL    UART_Send
+    MOVF    sent_pressure, W
+    BTFSC   delta_map, 2
+    CALL    UART_Send
+    MOVF    sent_light, W
+    BTFSC   delta_map, 3
+    CALL    UART_Send
+    RETURN
+
+Delta_Snapshot:
+    MOVF    curtain_current, W
+    MOVWF   sent_curtain
+    MOVF    outdoor_temp, W
+    MOVWF   sent_outdoor
+    MOVF    pressure_val, W
+    MOVWF   sent_pressure
+    MOVF    light_val, W
+    MOVWF   sent_light
     RETURN
 
     END
\ No newline at end of file
@@ -5,6 +5,22 @@
 #include <ctime>   // Zaman fonksiyonları için
 #include <thread>  // Bekleme (sleep) için
 #include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <atomic>
+
+#ifndef _WIN32
+#include "microfall_shm.h" // Paylasimli bellek yayini (POSIX)
+#include "microfall_link.h" // Cerceveli seri baglanti (POSIX)
+#endif
+
+// Cerceve basina hat uzerindeki ek byte (microfall_link.h): 2 x 0x00, COBS
+// kodu, etiket, CRC-8
+const int LINK_FRAME_OVERHEAD = 5;
 
 // TEST_MODE true ise gerçek seri port yerine sanal veri üretir.
 const bool TEST_MODE = true; 
@@ -25,13 +41,13 @@ public:
         portName = port;
         baudRate = baud;
         connected = true;
-        if (TEST_MODE) cout << "[TEST] " << port << " portuna " << baud << " ile baglanildi.\n";
+        if (TEST_MODE) cerr << "[TEST] " << port << " portuna " << baud << " ile baglanildi.\n";
         return true;
     }
 
     void close() {
         connected = false;
-        if (TEST_MODE) cout << "[TEST] Baglanti kapatildi.\n";
+        if (TEST_MODE) cerr << "[TEST] Baglanti kapatildi.\n";
     }
 
     void writeByte(unsigned char data) {
@@ -51,15 +67,147 @@ public:
 
 // Base Class
 class HomeAutomationSystemConnection {
+public:
+    typedef function<void(int field, double value)> ChangeCallback;
+
 protected:
     MockSerial serialPort;
     int comPortNumber; // Basitlik için int tutuyoruz, string "COMx" de olabilir
     int baudRate;
 
+#ifndef _WIN32
+    // Port yolu verildiyse gercek kart: COBS + CRC-8 cerceveli istekler
+    string portPath;
+    FramedLink link;
+#endif
+
+    // Degisiklik abonelikleri (deadband + minimum aralik)
+    struct Subscription {
+        int id;
+        int field;
+        double deadband;     // Bildirim icin gereken minimum degisim
+        double minInterval;  // Iki bildirim arasi minimum sure (s)
+        ChangeCallback callback;
+        bool notified;       // Ilk ornek her zaman bildirilir
+        double lastValue;    // Son bildirilen deger (histerezis referansi)
+        chrono::steady_clock::time_point lastTime;
+    };
+    vector<Subscription> subscriptions;
+    int nextSubscriptionId;
+
+    // Delta telemetri: 0x0A <ack seq> yalnizca degisen alanlari, 0x0B hepsini
+    // dondurur. Cevap: [seq] [bitmap] [bit basina deger]
+    bool deltaMode;
+    bool deltaSynced;       // false -> bir sonraki istek tam resync (0x0B)
+    unsigned char deltaSeq; // Son kabul edilen cevabin sira numarasi
+    int deltaResyncs;
+
+    virtual bool readField(int field) = 0; // Alt siniflar protokolu uygular; cevap yoksa false
+
+    // Delta bitini alana cevirir ve degeri yazar; guncellenen alani dondurur
+    virtual int applyDeltaValue(int bit, unsigned char value) = 0;
+
+    // Komutlari tek istek olarak gonderir ve tum cevap baytlarini toplar.
+    // Bagli kartta tek cerceve; sanal portta her get komutu bir bayt doner.
+    bool exchange(const vector<unsigned char> &commands, vector<unsigned char> &reply) {
+        reply.clear();
+#ifndef _WIN32
+        if (link.isOpen()) return link.request(commands, reply);
+#endif
+        if (!serialPort.connected) return false;
+        for (unsigned char cmd : commands) {
+            serialPort.writeByte(cmd);
+            if (cmd < 0x80) reply.push_back(serialPort.readByte()); // Set komutlari cevapsiz
+        }
+        return true;
+    }
+
+    bool pollDelta() {
+        bool resync = !deltaSynced;
+        vector<unsigned char> reply;
+        bool ok = resync ? exchange({0x0B}, reply)
+                         : exchange({0x0A, deltaSeq}, reply); // Son alinan cevabi onayla
+        if (!ok) {
+            deltaSynced = false;
+            return false;
+        }
+
+        size_t expected = 2;
+        if (reply.size() >= 2) {
+            for (int bit = 0; bit < 8; bit++) {
+                if (reply[1] & (1 << bit)) expected++;
+            }
+        }
+        if (reply.size() != expected) {
+            deltaSynced = false;
+            return false;
+        }
+
+        // Kayip cevap: kartin referansi bizimkinden farkli olabilir, tam resync.
+        // Kartin seq degeri 1..255 arasinda doner (0x00 hic kullanilmaz).
+        unsigned char nextSeq = deltaSeq == 255 ? 1 : deltaSeq + 1;
+        if (!resync && reply[0] != nextSeq) {
+            deltaSynced = false;
+            deltaResyncs++;
+            return pollDelta();
+        }
+        deltaSeq = reply[0];
+        deltaSynced = true;
+
+        size_t next = 2;
+        for (int bit = 0; bit < 8; bit++) {
+            if (reply[1] & (1 << bit)) applyDeltaValue(bit, reply[next++]);
+        }
+
+        // Bitmap yalnizca kartin son onaydan beri degisenleri tasir; minInterval
+        // yuzunden ertelenen bir degisiklik tekrar gelmez. Tum alanlar yeniden
+        // denetlenir (hat trafigi yok).
+        for (int field = 0; field < fieldCount(); field++) notifySubscribers(field);
+        return true;
+    }
+
+    void notifySubscribers(int field) {
+        if (subscriptions.empty()) return;
+        double value = fieldValue(field);
+        auto now = chrono::steady_clock::now();
+
+        // Callback'ler subscribe/unsubscribe cagirabilir (or. kural yeniden
+        // yukleme): once bildirilecekleri sec, sonra kopyalar uzerinden cagir
+        vector<pair<int, ChangeCallback>> due;
+        for (auto &s : subscriptions) {
+            if (s.field != field) continue;
+            if (s.notified) {
+                double delta = fabs(value - s.lastValue);
+                if (delta == 0 || delta < s.deadband) continue; // Deadband 0: yalnizca degisimde
+                if (chrono::duration<double>(now - s.lastTime).count() < s.minInterval) continue;
+            }
+            s.notified = true;
+            s.lastValue = value;
+            s.lastTime = now;
+            due.push_back({s.id, s.callback});
+        }
+
+        for (auto &d : due) {
+            if (isSubscribed(d.first)) d.second(field, value); // Arada iptal edilmis olabilir
+        }
+    }
+
+    bool isSubscribed(int id) {
+        for (auto &s : subscriptions) {
+            if (s.id == id) return true;
+        }
+        return false;
+    }
+
 public:
     HomeAutomationSystemConnection() {
         comPortNumber = 1;
         baudRate = 9600;
+        nextSubscriptionId = 1;
+        deltaMode = false;
+        deltaSynced = false;
+        deltaSeq = 0;
+        deltaResyncs = 0;
     }
 
     void setComPort(int port) {
@@ -70,17 +218,110 @@ public:
         baudRate = rate;
     }
 
+#ifndef _WIN32
+    // Gercek kart portu (or. pic16sim --link /tmp/ttyAC); bos ise sanal port
+    void setPortPath(const string &path) {
+        portPath = path;
+    }
+#endif
+
     bool open() {
+#ifndef _WIN32
+        if (!portPath.empty()) {
+            if (link.open(portPath, baudRate)) return true;
+            cerr << portPath << " acilamadi.\n";
+            return false;
+        }
+#endif
         string pName = "COM" + to_string(comPortNumber);
         return serialPort.open(pName, baudRate);
     }
 
     bool close() {
+#ifndef _WIN32
+        if (link.isOpen()) {
+            link.close();
+            return true;
+        }
+#endif
         serialPort.close();
         return true;
     }
 
-    virtual void update() = 0; // Pure virtual, alt sınıflar dolduracak
+    bool isConnected() {
+#ifndef _WIN32
+        if (link.isOpen()) return true;
+#endif
+        return serialPort.connected;
+    }
+
+    // Delta telemetri yalnizca gercek kartla calisir (sanal veri protokolu takip etmez)
+    bool isLinked() {
+#ifndef _WIN32
+        return link.isOpen();
+#else
+        return false;
+#endif
+    }
+
+    // Field-level access: each field is one request/reply group on the link
+    virtual int fieldCount() = 0;
+    virtual const char* fieldName(int field) = 0;
+    virtual int fieldRequestBytes(int field) = 0; // request bytes sent (one reply byte each)
+    virtual double fieldValue(int field) = 0;
+    virtual bool isWritable(int field) = 0;
+    virtual bool writeField(int field, double value) = 0; // false if read-only, out of range or unanswered
+
+    // Set komutlari 11xxxxxx (tam) / 10xxxxxx (ondalik): tam kisim 6 bit
+    static const int SET_VALUE_MAX = 63;
+    static bool isSettableValue(double value) { return value >= 0 && value < SET_VALUE_MAX + 1; }
+
+    // Alani okur ve degisiklik varsa abonelere bildirir. Delta modunda tek
+    // istek kartin tum alanlarini gunceller. Kart cevap vermezse false.
+    bool pollField(int field) {
+        if (!isConnected()) return false;
+        if (deltaMode) return pollDelta();
+        if (!readField(field)) return false;
+        notifySubscribers(field);
+        return true;
+    }
+
+    void setDeltaMode(bool enabled) {
+        deltaMode = enabled;
+        deltaSynced = false;
+    }
+
+    bool isDeltaMode() { return deltaMode; }
+    int getDeltaResyncs() { return deltaResyncs; }
+
+    // Callback fires when the field moves at least `deadband` away from the
+    // last value it was told about, and no sooner than `minInterval` seconds
+    // after the previous call. Returns an id for unsubscribe().
+    int subscribe(int field, double deadband, double minInterval, ChangeCallback callback) {
+        int id = nextSubscriptionId++;
+        subscriptions.push_back({id, field, deadband, minInterval, callback, false, 0.0, {}});
+        return id;
+    }
+
+    bool unsubscribe(int id) {
+        for (size_t i = 0; i < subscriptions.size(); i++) {
+            if (subscriptions[i].id == id) {
+                subscriptions.erase(subscriptions.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Tum alanlari sirayla yeniler
+    virtual void update() {
+        if (!isConnected()) return;
+        if (deltaMode) {
+            pollDelta();
+            return;
+        }
+        for (int i = 0; i < fieldCount(); i++) pollField(i);
+    }
     
     // Yardımcı getter
     int getPortNum() { return comPortNumber; }
@@ -89,6 +330,9 @@ public:
 
 // Board #1 Class
 class AirConditionerSystemConnection : public HomeAutomationSystemConnection {
+public:
+    enum Field { AMBIENT_TEMP, FAN_SPEED, DESIRED_TEMP, FIELD_COUNT };
+
 private:
     float desiredTemperature;
     float ambientTemperature;
@@ -101,32 +345,63 @@ public:
         fanSpeed = 0;
     }
 
-    // Dokuman Sayfa 16'daki Tabloya gore verileri ceker [cite: 675]
-    void update() override {
-        if (!serialPort.connected) return;
+    int fieldCount() override { return FIELD_COUNT; }
+
+    const char* fieldName(int field) override {
+        static const char* names[FIELD_COUNT] = {"ac.ambient", "ac.fan", "ac.desired"};
+        return names[field];
+    }
+
+    int fieldRequestBytes(int field) override { return field == FAN_SPEED ? 1 : 2; }
 
-        // 1. Ortam Sicakligi (Low ve High Byte)
-        serialPort.writeByte(0x03); // İstek gönder
-        int amb_low = serialPort.readByte();
-        serialPort.writeByte(0x04);
-        int amb_high = serialPort.readByte();
-        ambientTemperature = amb_high + (amb_low / 10.0f); // Örnek birleştirme
+    bool isWritable(int field) override { return field == DESIRED_TEMP; }
 
-        // 2. Fan Hizi
-        serialPort.writeByte(0x05);
-        fanSpeed = serialPort.readByte(); // Doğrudan rps
+    bool writeField(int field, double value) override {
+        return isWritable(field) && setDesiredTemp((float)value);
+    }
 
-        // 3. Istenen Sicaklik (Okuma)
-        serialPort.writeByte(0x01);
-        int des_low = serialPort.readByte();
-        serialPort.writeByte(0x02);
-        int des_high = serialPort.readByte();
-        desiredTemperature = des_high + (des_low / 10.0f);
+    double fieldValue(int field) override {
+        if (field == AMBIENT_TEMP) return ambientTemperature;
+        if (field == FAN_SPEED) return fanSpeed;
+        return desiredTemperature;
     }
 
+protected:
+    // Delta bitleri: 0 = Istenen (tam), 1 = Ortam, 2 = Fan, 3 = Istenen
+    // (ondalik) (Board1_AirConditioner.s)
+    int applyDeltaValue(int bit, unsigned char value) override {
+        float whole = floor(desiredTemperature);
+        if (bit == 0) { desiredTemperature = value + (desiredTemperature - whole); return DESIRED_TEMP; }
+        if (bit == 1) { ambientTemperature = value; return AMBIENT_TEMP; }
+        if (bit == 2) { fanSpeed = value; return FAN_SPEED; }
+        if (bit == 3) { desiredTemperature = whole + value / 10.0f; return DESIRED_TEMP; }
+        return -1;
+    }
+
+    // Dokuman Sayfa 16'daki Tabloya gore verileri ceker [cite: 675]
+    bool readField(int field) override {
+        vector<unsigned char> reply;
+
+        if (field == AMBIENT_TEMP) {
+            // 1. Ortam Sicakligi (Low ve High Byte)
+            if (!exchange({0x03, 0x04}, reply) || reply.size() != 2) return false;
+            ambientTemperature = reply[1] + (reply[0] / 10.0f); // Örnek birleştirme
+        } else if (field == FAN_SPEED) {
+            // 2. Fan Hizi
+            if (!exchange({0x05}, reply) || reply.size() != 1) return false;
+            fanSpeed = reply[0]; // Doğrudan rps
+        } else if (field == DESIRED_TEMP) {
+            // 3. Istenen Sicaklik (Okuma)
+            if (!exchange({0x01, 0x02}, reply) || reply.size() != 2) return false;
+            desiredTemperature = reply[1] + (reply[0] / 10.0f);
+        }
+        return true;
+    }
+
+public:
     // Dokuman Sayfa 16 - Set Desired Temp [cite: 675]
     bool setDesiredTemp(float temp) {
-        if (!serialPort.connected) return false;
+        if (!isConnected() || !isSettableValue(temp)) return false;
 
         int high = (int)temp;
         int low = (int)((temp - high) * 10);
@@ -135,10 +410,9 @@ public:
         unsigned char cmd_low = 0b10000000 | (low & 0x3F);
         unsigned char cmd_high = 0b11000000 | (high & 0x3F);
 
-        serialPort.writeByte(cmd_low);
-        // Çok hızlı göndermemek için ufak bir bekleme gerekebilir
-        this_thread::sleep_for(chrono::milliseconds(50)); 
-        serialPort.writeByte(cmd_high);
+        // Iki komut tek istekte; bos cevap karttan onaydir
+        vector<unsigned char> reply;
+        if (!exchange({cmd_low, cmd_high}, reply)) return false;
 
         desiredTemperature = temp; // Lokal değişkeni de güncelle
         return true;
@@ -151,6 +425,9 @@ public:
 
 // Board #2 Class
 class CurtainControlSystemConnection : public HomeAutomationSystemConnection {
+public:
+    enum Field { OUTDOOR_TEMP, CURTAIN_STATUS, OUTDOOR_PRESSURE, LIGHT_INTENSITY, FIELD_COUNT };
+
 private:
     float curtainStatus;
     float outdoorTemperature;
@@ -165,34 +442,70 @@ public:
         lightIntensity = 0.0;
     }
 
-    // Dokuman Sayfa 19'daki Tabloya gore verileri ceker [cite: 719]
-    void update() override {
-        if (!serialPort.connected) return;
+    int fieldCount() override { return FIELD_COUNT; }
+
+    const char* fieldName(int field) override {
+        static const char* names[FIELD_COUNT] = {
+            "curtain.outdoor", "curtain.status", "curtain.pressure", "curtain.light"
+        };
+        return names[field];
+    }
+
+    int fieldRequestBytes(int field) override { return field == OUTDOOR_TEMP ? 2 : 1; }
 
-        // 1. Dis Sicaklik
-        serialPort.writeByte(0x03);
-        int out_low = serialPort.readByte();
-        serialPort.writeByte(0x04);
-        int out_high = serialPort.readByte();
-        outdoorTemperature = out_high + (out_low / 10.0f);
+    bool isWritable(int field) override { return field == CURTAIN_STATUS; }
 
-        // 2. Perde Durumu
-        // Burada sadece high byte örneği yapıyoruz, dokümanda fractional da var
-        serialPort.writeByte(0x02); 
-        curtainStatus = (float)serialPort.readByte(); 
+    bool writeField(int field, double value) override {
+        return isWritable(field) && setCurtainStatus((float)value);
+    }
+
+    double fieldValue(int field) override {
+        if (field == OUTDOOR_TEMP) return outdoorTemperature;
+        if (field == CURTAIN_STATUS) return curtainStatus;
+        if (field == OUTDOOR_PRESSURE) return outdoorPressure;
+        return lightIntensity;
+    }
 
-        // 3. Basinc
-        serialPort.writeByte(0x06);
-        outdoorPressure = (float)serialPort.readByte() * 10; // Örnek ölçekleme
+protected:
+    // Delta bitleri: 0 = Perde, 1 = Dis Sicaklik, 2 = Basinc, 3 = Isik
+    // (Board2_Curtain.s); olcekleme eski okumalarla ayni
+    int applyDeltaValue(int bit, unsigned char value) override {
+        if (bit == 0) { curtainStatus = value; return CURTAIN_STATUS; }
+        if (bit == 1) { outdoorTemperature = value; return OUTDOOR_TEMP; }
+        if (bit == 2) { outdoorPressure = (float)value * 10; return OUTDOOR_PRESSURE; }
+        if (bit == 3) { lightIntensity = (double)value * 10; return LIGHT_INTENSITY; }
+        return -1;
+    }
+
+    // Dokuman Sayfa 19'daki Tabloya gore verileri ceker [cite: 719]
+    bool readField(int field) override {
+        vector<unsigned char> reply;
 
-        // 4. Isik Siddeti
-        serialPort.writeByte(0x08);
-        lightIntensity = (double)serialPort.readByte() * 10; 
+        if (field == OUTDOOR_TEMP) {
+            // 1. Dis Sicaklik
+            if (!exchange({0x03, 0x04}, reply) || reply.size() != 2) return false;
+            outdoorTemperature = reply[1] + (reply[0] / 10.0f);
+        } else if (field == CURTAIN_STATUS) {
+            // 2. Perde Durumu
+            // Burada sadece high byte örneği yapıyoruz, dokümanda fractional da var
+            if (!exchange({0x02}, reply) || reply.size() != 1) return false;
+            curtainStatus = (float)reply[0];
+        } else if (field == OUTDOOR_PRESSURE) {
+            // 3. Basinc
+            if (!exchange({0x06}, reply) || reply.size() != 1) return false;
+            outdoorPressure = (float)reply[0] * 10; // Örnek ölçekleme
+        } else if (field == LIGHT_INTENSITY) {
+            // 4. Isik Siddeti
+            if (!exchange({0x08}, reply) || reply.size() != 1) return false;
+            lightIntensity = (double)reply[0] * 10;
+        }
+        return true;
     }
 
+public:
     // Dokuman Sayfa 19 - Set Curtain Status [cite: 719]
     bool setCurtainStatus(float status) {
-        if (!serialPort.connected) return false;
+        if (!isConnected() || !isSettableValue(status)) return false;
 
         int val = (int)status;
         
@@ -200,9 +513,8 @@ public:
         unsigned char cmd_low = 0b10000000 | (0 & 0x3F); // Ondalık kısım 0 varsayıldı
         unsigned char cmd_high = 0b11000000 | (val & 0x3F);
 
-        serialPort.writeByte(cmd_low);
-        this_thread::sleep_for(chrono::milliseconds(50));
-        serialPort.writeByte(cmd_high);
+        vector<unsigned char> reply;
+        if (!exchange({cmd_low, cmd_high}, reply)) return false;
 
         curtainStatus = status;
         return true;
@@ -214,6 +526,371 @@ public:
     float getCurtainStatus() { return curtainStatus; }
 };
 
+// --- MULTI-RATE POLL SCHEDULER ---
+// Her alan kendi hedef periyoduyla okunur. Zamani gelen istekler iki kart
+// arasinda en yakin deadline once (EDF) sirasiyla gonderilir; yavas degisen
+// alanlar (basinc, isik) hizli olanlarin (fan) bant genisligini yemez.
+class PollScheduler {
+private:
+    struct Entry {
+        HomeAutomationSystemConnection* conn;
+        int field;
+        double period;   // Hedef ornekleme periyodu (s)
+        double release;  // Bir sonraki okumanin zamani (s)
+        double cost;     // Bir okumanin hat suresi (s)
+    };
+
+    vector<Entry> entries;
+    chrono::steady_clock::time_point start;
+    int missedDeadlines;
+
+    // Menuler cin'de beklerken de okumalar surer: service() ayri bir
+    // is parcaciginda doner, hat erisimi linkMutex ile siralanir.
+    thread worker;
+    atomic<bool> running;
+    mutex linkMutex;
+
+    double now() {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    void checkLoad(HomeAutomationSystemConnection &conn, int field, double periodSeconds) {
+        double load = linkLoad(conn.getPortNum());
+        if (load > 1.0) {
+            cout << "[SCHED] COM" << conn.getPortNum() << " oversubscribed: "
+                 << (int)(load * 100) << "% of " << conn.getBaud() << " baud ("
+                 << conn.fieldName(field) << " @ " << periodSeconds << " s)\n";
+        }
+    }
+
+public:
+    PollScheduler() : start(chrono::steady_clock::now()), missedDeadlines(0), running(false) {}
+
+    ~PollScheduler() { stopPolling(); }
+
+    void addField(HomeAutomationSystemConnection &conn, int field, double periodSeconds) {
+        // Delta modunda tek istek kartin tum alanlarini yeniler: kart basina
+        // tek giris, istenen en kisa periyotla
+        if (conn.isDeltaMode()) {
+            for (auto &e : entries) {
+                if (e.conn != &conn) continue;
+                e.period = min(e.period, periodSeconds);
+                checkLoad(conn, field, periodSeconds);
+                return;
+            }
+        }
+
+        // Her istek byte'i bir cevap byte'i bekler: karakter basina 10 bit (8N1).
+        // Delta modunda sabit durumda 2 istek + 2 cevap byte'i.
+        int bytes = conn.isDeltaMode() ? 2 : conn.fieldRequestBytes(field);
+        int wireBytes = bytes * 2;
+        // Cerceveli baglantida her yon ayrica 2 ayirici + COBS kodu + etiket + CRC
+        if (conn.isLinked()) wireBytes += 2 * LINK_FRAME_OVERHEAD;
+        double cost = wireBytes * 10.0 / conn.getBaud();
+        entries.push_back({&conn, field, periodSeconds, now(), cost});
+        checkLoad(conn, field, periodSeconds);
+    }
+
+    // Fraction of a port's bandwidth the configured periods require
+    double linkLoad(int port) {
+        double load = 0;
+        for (auto &e : entries) {
+            if (e.conn->getPortNum() == port) load += e.cost / e.period;
+        }
+        return load;
+    }
+
+    bool isOversubscribed() {
+        for (auto &e : entries) {
+            if (linkLoad(e.conn->getPortNum()) > 1.0) return true;
+        }
+        return false;
+    }
+
+    int getMissedDeadlines() { return missedDeadlines; }
+
+    // Baglantilara (okuma, set, ekrana basilan degerler) erismeden once kilitlenir
+    mutex &getLinkMutex() { return linkMutex; }
+
+    // service()'i her `tickSeconds`'ta bir, kullanici girdisinden bagimsiz cagirir
+    void startPolling(double tickSeconds = 0.01) {
+        if (running) return;
+        running = true;
+        worker = thread([this, tickSeconds]() {
+            while (running) {
+                {
+                    lock_guard<mutex> lock(linkMutex);
+                    service();
+                }
+                this_thread::sleep_for(chrono::duration<double>(tickSeconds));
+            }
+        });
+    }
+
+    void stopPolling() {
+        running = false;
+        if (worker.joinable()) worker.join();
+    }
+
+    // Zamani gelen tum alanlari EDF sirasiyla okur, okunan alan sayisini dondurur
+    int service() {
+        double t = now();
+        vector<Entry*> due;
+        for (auto &e : entries) {
+            if (e.release <= t) due.push_back(&e);
+        }
+        sort(due.begin(), due.end(), [](Entry* a, Entry* b) {
+            return a->release + a->period < b->release + b->period;
+        });
+
+        for (Entry* e : due) {
+            e->conn->pollField(e->field);
+            double done = now();
+            if (done > e->release + e->period) missedDeadlines++;
+            e->release += e->period;
+            if (e->release < done) e->release = done; // Birikmis okumalari atla
+        }
+        return (int)due.size();
+    }
+};
+
+// Metnin tamami sayi ise true (stod/stof gibi istisna atmaz)
+bool parseNumber(const string &text, double &value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return *end == '\0' && isfinite(value);
+}
+
+// --- RULE ENGINE (OTOMATIK KONTROL) ---
+// Kural dosyasi satir formati:
+//   <girdi> <op> <esik> -> <cikti> <deger>
+//   curtain.light > 500 -> curtain.status 60
+//   curtain.outdoor < 5 -> ac.desired +1      (+/- : mevcut degere gore)
+// Ciktilar yazilabilir alan olmali ve degerler set kodlamasina (0-63)
+// sigmali; goreli hedefler calisma aninda bu araliga kirpilir.
+// Kurallar yuklenirken alan isimleri slot indekslerine cevrilir; her girdi
+// slotu kendi kural listesini tutar ve yalnizca o alan degistiginde
+// (abonelik callback'i) bu liste degerlendirilir. Kurallar kenar
+// tetiklidir: kosul yanlis -> dogru gecisinde bir kez calisir.
+class RuleEngine {
+private:
+    enum Op : unsigned char { GT, LT, GE, LE };
+
+    struct Slot {
+        HomeAutomationSystemConnection* conn;
+        int field;
+        string name;
+        bool sampled;           // Karttan en az bir deger okundu mu
+    };
+
+    struct CompiledRule {
+        unsigned short input;   // Slot indeksi
+        unsigned short output;  // Slot indeksi
+        Op op;
+        bool relative;
+        bool active;            // Kosulun son durumu (kenar tespiti)
+        float threshold;
+        float value;
+    };
+
+    vector<Slot> slots;
+    vector<CompiledRule> rules;
+    vector<vector<unsigned short>> rulesByInput; // Slot -> kural indeksleri
+    vector<int> subscriptionIds;
+    int firedCount;
+
+    int findSlot(const string &name) {
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].name == name) return (int)i;
+        }
+        return -1;
+    }
+
+    void evaluateRule(CompiledRule &r, double v) {
+        bool cond;
+        switch (r.op) {
+        case GT: cond = v > r.threshold; break;
+        case LT: cond = v < r.threshold; break;
+        case GE: cond = v >= r.threshold; break;
+        default: cond = v <= r.threshold; break;
+        }
+        if (cond && !r.active) {
+            Slot &out = slots[r.output];
+            // Goreli deger cikisin gercek degerine gore: ilk ornek gelene
+            // kadar kural bekler (onSample tekrar dener)
+            if (r.relative && !out.sampled) return;
+            double target = r.relative ? out.conn->fieldValue(out.field) + r.value : r.value;
+            target = max(0.0, min(target, (double)HomeAutomationSystemConnection::SET_VALUE_MAX));
+            if (out.conn->writeField(out.field, target)) firedCount++;
+        }
+        r.active = cond;
+    }
+
+    void onSample(unsigned short slot, double v) {
+        bool first = !slots[slot].sampled;
+        slots[slot].sampled = true;
+        for (unsigned short idx : rulesByInput[slot]) evaluateRule(rules[idx], v);
+        if (!first) return;
+
+        // Bu cikisin ilk ornegini bekleyen goreli kurallar
+        for (auto &r : rules) {
+            Slot &in = slots[r.input];
+            if (r.relative && r.output == slot && r.input != slot && in.sampled)
+                evaluateRule(r, in.conn->fieldValue(in.field));
+        }
+    }
+
+public:
+    RuleEngine() : firedCount(0) {}
+
+    ~RuleEngine() { clearRules(); }
+
+    // Kartin alanlarini kural isimleriyle kaydeder. `alias` verilirse
+    // alan isminin on eki ("ac", "curtain") onunla degistirilir; ayni
+    // tipte birden fazla kart icin ("ac2.ambient").
+    void addBoard(HomeAutomationSystemConnection &conn, const string &alias = "") {
+        for (int f = 0; f < conn.fieldCount(); f++) {
+            string name = conn.fieldName(f);
+            if (!alias.empty()) name = alias + name.substr(name.find('.'));
+            slots.push_back({&conn, f, name, false});
+        }
+        rulesByInput.resize(slots.size());
+    }
+
+    void clearRules() {
+        for (size_t i = 0; i < subscriptionIds.size(); i++) {
+            if (subscriptionIds[i]) slots[i].conn->unsubscribe(subscriptionIds[i]);
+        }
+        subscriptionIds.clear();
+        rules.clear();
+        for (auto &list : rulesByInput) list.clear();
+    }
+
+    // Kural dosyasini derler ve gerekli alanlara abone olur. Hatali satirda
+    // mesaj yazar ve false dondurur (onceki kurallar silinmis olur).
+    bool loadRules(const string &path) {
+        clearRules();
+        ifstream in(path);
+        if (!in) {
+            cout << "[RULES] Cannot open " << path << "\n";
+            return false;
+        }
+
+        string line;
+        int lineNo = 0;
+        while (getline(in, line)) {
+            lineNo++;
+            size_t hash = line.find('#');
+            if (hash != string::npos) line.erase(hash);
+
+            istringstream ss(line);
+            string input, op, arrow, output, value;
+            float threshold;
+            if (!(ss >> input)) continue; // Bos satir
+
+            if (!(ss >> op >> threshold >> arrow >> output >> value) || arrow != "->") {
+                cout << "[RULES] " << path << ":" << lineNo << ": syntax error\n";
+                clearRules();
+                return false;
+            }
+
+            CompiledRule r;
+            int in_slot = findSlot(input);
+            int out_slot = findSlot(output);
+            if (in_slot < 0 || out_slot < 0) {
+                cout << "[RULES] " << path << ":" << lineNo << ": unknown field '"
+                     << (in_slot < 0 ? input : output) << "'\n";
+                clearRules();
+                return false;
+            }
+
+            if (op == ">") r.op = GT;
+            else if (op == "<") r.op = LT;
+            else if (op == ">=") r.op = GE;
+            else if (op == "<=") r.op = LE;
+            else {
+                cout << "[RULES] " << path << ":" << lineNo << ": bad operator '" << op << "'\n";
+                clearRules();
+                return false;
+            }
+
+            Slot &out = slots[out_slot];
+            if (!out.conn->isWritable(out.field)) {
+                cout << "[RULES] " << path << ":" << lineNo << ": '" << output << "' is read-only\n";
+                clearRules();
+                return false;
+            }
+
+            double number;
+            if (!parseNumber(value, number)) {
+                cout << "[RULES] " << path << ":" << lineNo << ": syntax error\n";
+                clearRules();
+                return false;
+            }
+            r.relative = (value[0] == '+' || value[0] == '-');
+            if (!r.relative && !HomeAutomationSystemConnection::isSettableValue(number)) {
+                cout << "[RULES] " << path << ":" << lineNo << ": value " << value
+                     << " out of range (0-" << HomeAutomationSystemConnection::SET_VALUE_MAX << ")\n";
+                clearRules();
+                return false;
+            }
+
+            r.input = (unsigned short)in_slot;
+            r.output = (unsigned short)out_slot;
+            r.value = (float)number;
+            r.threshold = threshold;
+            r.active = false;
+            rulesByInput[in_slot].push_back((unsigned short)rules.size());
+            rules.push_back(r);
+        }
+
+        // Kullanilan her girdi ve goreli kural cikisi alanina tek abonelik
+        vector<bool> watched(slots.size(), false);
+        for (auto &r : rules) {
+            watched[r.input] = true;
+            if (r.relative) watched[r.output] = true;
+        }
+        subscriptionIds.assign(slots.size(), 0);
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!watched[i]) continue;
+            unsigned short slot = (unsigned short)i;
+            subscriptionIds[i] = slots[i].conn->subscribe(slots[i].field, 0, 0,
+                [this, slot](int, double v) { onSample(slot, v); });
+        }
+        return true;
+    }
+
+    int getRuleCount() { return (int)rules.size(); }
+    int getFiredCount() { return firedCount; }
+};
+
+#ifndef _WIN32
+// Kartin tum alanlarini paylasimli bellege yazar; herhangi bir alan
+// degistiginde kartin anlik goruntusu yeniden yayinlanir.
+void publishBoard(StatePublisher &state, HomeAutomationSystemConnection &conn) {
+    string names[STATE_MAX_FIELDS];
+    int count = min(conn.fieldCount(), STATE_MAX_FIELDS);
+    for (int f = 0; f < count; f++) names[f] = conn.fieldName(f);
+
+    int slot = state.addBoard(names, count);
+    if (slot < 0) return;
+
+    auto publish = [&state, &conn, slot, count](int, double) {
+        double values[STATE_MAX_FIELDS];
+        for (int f = 0; f < count; f++) values[f] = conn.fieldValue(f);
+        state.publish(slot, values, count);
+    };
+    for (int f = 0; f < count; f++) conn.subscribe(f, 0, 0, publish);
+}
+
+// Ctrl-C / kill: segment'i kaldir, okuyucular eski degerleri gormesin
+void onTerminate(int sig) {
+    StatePublisher::unlinkSegment();
+    _exit(128 + sig);
+}
+#endif
+
 // --- 2.4 APPLICATION MENUS (FIGURE 18) ---
 
 void clearScreen() {
@@ -221,10 +898,30 @@ void clearScreen() {
     system("cls"); 
 }
 
-void airConditionerMenu(AirConditionerSystemConnection &ac) {
+// Hat yuku ve kacirilan deadline'lar (okumalar arka planda surer)
+// Set komutunun sonucu: aralik disi deger ya da cevapsiz kart sessizce yutulmaz
+void printSetResult(float value, bool sent) {
+    if (sent) {
+        cout << "Veri gonderiliyor...\n";
+    } else if (!HomeAutomationSystemConnection::isSettableValue(value)) {
+        cout << "Hata: deger 0-" << HomeAutomationSystemConnection::SET_VALUE_MAX
+             << " araliginda olmali, gonderilmedi.\n";
+    } else {
+        cout << "Hata: kart cevap vermedi.\n";
+    }
+}
+
+void printLinkStatus(HomeAutomationSystemConnection &conn, PollScheduler &scheduler) {
+    cout << "Link Load: " << scheduler.linkLoad(conn.getPortNum()) * 100 << " %";
+    if (scheduler.isOversubscribed()) cout << " (OVERSUBSCRIBED)";
+    cout << "\n";
+    cout << "Missed Deadlines: " << scheduler.getMissedDeadlines() << "\n";
+}
+
+void airConditionerMenu(AirConditionerSystemConnection &ac, PollScheduler &scheduler) {
     int choice = 0;
     while (true) {
-        ac.update(); // Verileri yenile
+        unique_lock<mutex> lock(scheduler.getLinkMutex());
         clearScreen();
         cout << "--- AIR CONDITIONER ---\n";
         cout << "Home Ambient Temperature: " << ac.getAmbientTemp() << " C\n";
@@ -233,19 +930,24 @@ void airConditionerMenu(AirConditionerSystemConnection &ac) {
         cout << "-----------------------\n";
         cout << "Connection Port: COM" << ac.getPortNum() << "\n";
         cout << "Connection Baudrate: " << ac.getBaud() << "\n";
+        printLinkStatus(ac, scheduler);
         cout << "-----------------------\n";
         cout << "MENU\n";
         cout << "1. Enter the desired temperature\n";
         cout << "2. Return\n";
+        cout << "3. Refresh\n";
         cout << "Choice: ";
+        lock.unlock(); // Girdi beklenirken okumalar devam eder
         cin >> choice;
 
         if (choice == 1) {
-            float newTemp;
+            float newTemp = -1;
             cout << "Enter Desired Temp: ";
             cin >> newTemp;
-            ac.setDesiredTemp(newTemp);
-            cout << "Veri gonderiliyor...\n";
+            lock.lock();
+            bool sent = ac.setDesiredTemp(newTemp);
+            lock.unlock();
+            printSetResult(newTemp, sent);
             this_thread::sleep_for(chrono::seconds(1));
         } else if (choice == 2) {
             break;
@@ -253,10 +955,10 @@ void airConditionerMenu(AirConditionerSystemConnection &ac) {
     }
 }
 
-void curtainMenu(CurtainControlSystemConnection &cc) {
+void curtainMenu(CurtainControlSystemConnection &cc, PollScheduler &scheduler) {
     int choice = 0;
     while (true) {
-        cc.update(); // Verileri yenile
+        unique_lock<mutex> lock(scheduler.getLinkMutex());
         clearScreen();
         cout << "--- CURTAIN CONTROL ---\n";
         cout << "Outdoor Temperature: " << cc.getOutdoorTemp() << " C\n";
@@ -266,19 +968,24 @@ void curtainMenu(CurtainControlSystemConnection &cc) {
         cout << "-----------------------\n";
         cout << "Connection Port: COM" << cc.getPortNum() << "\n";
         cout << "Connection Baudrate: " << cc.getBaud() << "\n";
+        printLinkStatus(cc, scheduler);
         cout << "-----------------------\n";
         cout << "MENU\n";
         cout << "1. Enter the desired curtain status\n";
         cout << "2. Return\n";
+        cout << "3. Refresh\n";
         cout << "Choice: ";
+        lock.unlock(); // Girdi beklenirken okumalar devam eder
         cin >> choice;
 
         if (choice == 1) {
-            float newStatus;
+            float newStatus = -1;
             cout << "Enter Desired Curtain (%): ";
             cin >> newStatus;
-            cc.setCurtainStatus(newStatus);
-            cout << "Veri gonderiliyor...\n";
+            lock.lock();
+            bool sent = cc.setCurtainStatus(newStatus);
+            lock.unlock();
+            printSetResult(newStatus, sent);
             this_thread::sleep_for(chrono::seconds(1));
         } else if (choice == 2) {
             break;
@@ -286,7 +993,135 @@ void curtainMenu(CurtainControlSystemConnection &cc) {
     }
 }
 
-int main() {
+// --- COMMAND LINE MODE ---
+// Menu olmadan tek seferlik komutlar (cron / script kullanimi icin):
+//   microfall get ac.ambient curtain.light --format json
+//   microfall set ac.desired 22.5
+//   microfall batch komutlar.txt      (her satir bir get/set, "-" = stdin)
+// Ekran temizleme ve bekleme yok; cevaplar gelince cikar.
+
+bool findField(vector<HomeAutomationSystemConnection*> &boards, const string &name,
+               HomeAutomationSystemConnection* &conn, int &field) {
+    for (auto b : boards) {
+        for (int f = 0; f < b->fieldCount(); f++) {
+            if (name == b->fieldName(f)) {
+                conn = b;
+                field = f;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Tek bir get/set komutunu calistirir. 0 = basarili, 1 = kullanim hatasi
+// (bilinmeyen komut, sayi olmayan / aralik disi deger), 2 = bilinmeyen ya da
+// salt okunur alan, 3 = kart acilamadi ya da cevap vermedi.
+int runCommand(vector<HomeAutomationSystemConnection*> &boards, const vector<string> &args, bool json) {
+    if (args.empty()) return 0;
+    const string &cmd = args[0];
+
+    if (cmd == "get" && args.size() >= 2) {
+        vector<pair<string, double>> results;
+        for (size_t i = 1; i < args.size(); i++) {
+            HomeAutomationSystemConnection* conn;
+            int field;
+            if (!findField(boards, args[i], conn, field)) {
+                cerr << "Unknown field: " << args[i] << "\n";
+                return 2;
+            }
+            if (!conn->pollField(field)) {
+                cerr << "No reply from board for " << args[i] << "\n";
+                return 3;
+            }
+            results.push_back({args[i], conn->fieldValue(field)});
+        }
+
+        if (json) {
+            cout << "{";
+            for (size_t i = 0; i < results.size(); i++) {
+                cout << (i ? ", " : "") << "\"" << results[i].first << "\": " << results[i].second;
+            }
+            cout << "}\n";
+        } else {
+            for (auto &r : results) cout << r.first << " " << r.second << "\n";
+        }
+        return 0;
+    }
+
+    if (cmd == "set" && args.size() >= 3 && args.size() % 2 == 1) {
+        for (size_t i = 1; i < args.size(); i += 2) {
+            HomeAutomationSystemConnection* conn;
+            int field;
+            if (!findField(boards, args[i], conn, field)) {
+                cerr << "Unknown field: " << args[i] << "\n";
+                return 2;
+            }
+            double value;
+            if (!parseNumber(args[i + 1], value)) {
+                cerr << "Bad value for " << args[i] << ": " << args[i + 1] << "\n";
+                return 1;
+            }
+            if (conn->isWritable(field) && !HomeAutomationSystemConnection::isSettableValue(value)) {
+                cerr << "Value out of range for " << args[i] << ": " << args[i + 1]
+                     << " (0-" << HomeAutomationSystemConnection::SET_VALUE_MAX << ")\n";
+                return 1;
+            }
+            if (!conn->isWritable(field)) {
+                cerr << "Cannot set " << args[i] << "\n";
+                return 2;
+            }
+            if (!conn->writeField(field, value)) {
+                cerr << "No reply from board for " << args[i] << "\n";
+                return 3;
+            }
+        }
+        return 0;
+    }
+
+    cerr << "Bad command: " << cmd << "\n";
+    return 1;
+}
+
+int runCommandLine(vector<HomeAutomationSystemConnection*> &boards, int argc, char* argv[]) {
+    vector<string> args;
+    bool json = false;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--format" && i + 1 < argc) json = (string(argv[++i]) == "json");
+        else args.push_back(a);
+    }
+
+    if (args.size() == 2 && args[0] == "batch") {
+        ifstream file;
+        if (args[1] != "-") {
+            file.open(args[1]);
+            if (!file) {
+                cerr << "Cannot open " << args[1] << "\n";
+                return 1;
+            }
+        }
+        istream &in = (args[1] == "-") ? cin : file;
+
+        // Ayni baglanti uzerinden tum satirlar; ilk hatada durur
+        string line;
+        while (getline(in, line)) {
+            size_t hash = line.find('#');
+            if (hash != string::npos) line.erase(hash);
+            istringstream ss(line);
+            vector<string> cmd;
+            string word;
+            while (ss >> word) cmd.push_back(word);
+            int rc = runCommand(boards, cmd, json);
+            if (rc != 0) return rc;
+        }
+        return 0;
+    }
+
+    return runCommand(boards, args, json);
+}
+
+int main(int argc, char* argv[]) {
     srand(time(0)); // Rastgelelik icin seed
 
     AirConditionerSystemConnection acSystem;
@@ -296,9 +1131,61 @@ int main() {
     acSystem.setComPort(3);
     curtainSystem.setComPort(4);
 
+#ifndef _WIN32
+    // Gercek kart portlari (or. pic16sim --link); tanimsizsa sanal veri
+    if (const char *port = getenv("MICROFALL_AC_PORT")) acSystem.setPortPath(port);
+    if (const char *port = getenv("MICROFALL_CURTAIN_PORT")) curtainSystem.setPortPath(port);
+#endif
+
     // Baglantilari Ac
-    acSystem.open();
-    curtainSystem.open();
+    bool opened = acSystem.open();
+    opened = curtainSystem.open() && opened;
+
+    // Gercek kartlarda delta telemetri
+    acSystem.setDeltaMode(acSystem.isLinked());
+    curtainSystem.setDeltaMode(curtainSystem.isLinked());
+
+    // Arguman varsa menu yerine komut satiri modu
+    if (argc > 1) {
+        vector<HomeAutomationSystemConnection*> boards = {&acSystem, &curtainSystem};
+        int rc = opened ? runCommandLine(boards, argc, argv) : 3;
+        acSystem.close();
+        curtainSystem.close();
+        return rc;
+    }
+
+    // Alan basina hedef ornekleme periyotlari (s)
+    PollScheduler scheduler;
+    scheduler.addField(acSystem, AirConditionerSystemConnection::FAN_SPEED, 0.5);
+    scheduler.addField(acSystem, AirConditionerSystemConnection::AMBIENT_TEMP, 1.0);
+    scheduler.addField(acSystem, AirConditionerSystemConnection::DESIRED_TEMP, 5.0);
+    scheduler.addField(curtainSystem, CurtainControlSystemConnection::CURTAIN_STATUS, 1.0);
+    scheduler.addField(curtainSystem, CurtainControlSystemConnection::OUTDOOR_TEMP, 10.0);
+    scheduler.addField(curtainSystem, CurtainControlSystemConnection::LIGHT_INTENSITY, 5.0);
+    scheduler.addField(curtainSystem, CurtainControlSystemConnection::OUTDOOR_PRESSURE, 30.0);
+
+    // Otomatik kontrol kurallari (dosya yoksa devre disi)
+    RuleEngine rules;
+    rules.addBoard(acSystem);
+    rules.addBoard(curtainSystem);
+    if (ifstream("rules.conf")) rules.loadRules("rules.conf");
+
+#ifndef _WIN32
+    // Diger yerel surecler son degerleri microfall_shm.h ile okuyabilir
+    StatePublisher state;
+    if (state.open()) {
+        publishBoard(state, acSystem);
+        publishBoard(state, curtainSystem);
+        state.ready();
+        signal(SIGINT, onTerminate);
+        signal(SIGTERM, onTerminate);
+    } else {
+        // Baska bir ornek zaten yayinliyor; onun segment'ine dokunma
+        cerr << STATE_SEGMENT_NAME << " yayinlanamadi (baska bir ornek calisiyor olabilir).\n";
+    }
+#endif
+
+    scheduler.startPolling();
 
     int choice = 0;
     while (true) {
@@ -311,11 +1198,12 @@ int main() {
         cin >> choice;
 
         if (choice == 1) {
-            airConditionerMenu(acSystem);
+            airConditionerMenu(acSystem, scheduler);
         } else if (choice == 2) {
-            curtainMenu(curtainSystem);
+            curtainMenu(curtainSystem, scheduler);
         } else if (choice == 3) {
             cout << "Exiting...\n";
+            scheduler.stopPolling();
             acSystem.close();
             curtainSystem.close();
             break;
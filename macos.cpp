@@ -2,13 +2,10 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include <cmath>
 
 // macOS / POSIX specific headers
-#include <fcntl.h>      // For file control definitions
-#include <errno.h>      // For error number definitions
-#include <termios.h>    // For POSIX terminal control definitions
-#include <unistd.h>     // For UNIX standard definitions (read/write/close)
-#include <sys/ioctl.h>
+#include "microfall_link.h"  // Framed serial link (termios, COBS + CRC-8)
 
 using namespace std;
 
@@ -19,11 +16,62 @@ class HomeAutomationSystemConnection {
 protected:
     string portName;
     int baudRate;
-    int serial_fd; // File descriptor for serial port
     bool connected;
 
+    // Framed transport (COBS + CRC-8, tagged requests), see microfall_link.h
+    FramedLink link;
+
+    // --- Delta telemetry ---
+    // 0x0A <ack seq> returns only the fields changed since the acked reply,
+    // 0x0B all of them: [seq] [bitmap] [value per set bit, bit 0 first]
+    bool deltaMode;
+    bool deltaSynced;               // false -> next request is a resync (0x0B)
+    unsigned char deltaSeq;         // seq of the last reply applied
+    int deltaResyncs;
+
+    // Stores the value for one bitmap bit (board specific)
+    virtual void applyDeltaValue(int bit, unsigned char value) = 0;
+
+    bool pollDelta() {
+        bool resync = !deltaSynced;
+        vector<unsigned char> reply;
+        if (!awaitReply(resync ? submitRequest({0x0B}) : submitRequest({0x0A, deltaSeq}), reply)) {
+            deltaSynced = false;
+            return false;
+        }
+
+        size_t expected = 2;
+        if (reply.size() >= 2) {
+            for (int bit = 0; bit < 8; bit++) {
+                if (reply[1] & (1 << bit)) expected++;
+            }
+        }
+        if (reply.size() != expected) {
+            deltaSynced = false;
+            return false;
+        }
+
+        // A skipped seq means a reply we never applied: start over from a
+        // full snapshot. The board's seq runs 1..255 (never 0x00).
+        unsigned char nextSeq = deltaSeq == 255 ? 1 : deltaSeq + 1;
+        if (!resync && reply[0] != nextSeq) {
+            deltaSynced = false;
+            deltaResyncs++;
+            return pollDelta();
+        }
+        deltaSeq = reply[0];
+        deltaSynced = true;
+
+        size_t next = 2;
+        for (int bit = 0; bit < 8; bit++) {
+            if (reply[1] & (1 << bit)) applyDeltaValue(bit, reply[next++]);
+        }
+        return true;
+    }
+
 public:
-    HomeAutomationSystemConnection() : baudRate(9600), connected(false), serial_fd(-1) {}
+    HomeAutomationSystemConnection() : baudRate(9600), connected(false),
+        deltaMode(false), deltaSynced(false), deltaSeq(0), deltaResyncs(0) {}
 
     // On macOS, ports look like "/dev/tty.usbserial-XXXX" or "/dev/tty.SLAB_USBtoUART"
     void setPortPath(string port) { this->portName = port; }
@@ -32,76 +80,42 @@ public:
     void setBaudRate(int rate) { this->baudRate = rate; }
 
     bool openConnection() {
-        // Open the serial port (Read/Write, No controlling terminal, No delay)
-        serial_fd = open(portName.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
-        
-        if (serial_fd == -1) {
+        // Raw 8N1 at baudRate (PDF requires 9600 [cite: 310])
+        if (!link.open(portName, baudRate)) {
             perror("Unable to open port");
             return false;
         }
-
-        // Configure Port
-        struct termios options;
-        tcgetattr(serial_fd, &options); // Get current options
-
-        // Set Baud Rate (PDF requires 9600 [cite: 310])
-        speed_t speed;
-        switch(baudRate) {
-            case 9600: speed = B9600; break;
-            case 19200: speed = B19200; break;
-            case 115200: speed = B115200; break;
-            default: speed = B9600;
-        }
-        cfsetispeed(&options, speed);
-        cfsetospeed(&options, speed);
-
-        // Set 8N1 (8 Data bits, No Parity, 1 Stop bit) [cite: 310]
-        options.c_cflag &= ~PARENB; // No Parity
-        options.c_cflag &= ~CSTOPB; // 1 Stop Bit
-        options.c_cflag &= ~CSIZE;  // Mask character size bits
-        options.c_cflag |= CS8;     // 8 Data Bits
-
-        // Disable hardware flow control
-        options.c_cflag &= ~CRTSCTS;
-
-        // Enable receiver and set local mode
-        options.c_cflag |= (CLOCAL | CREAD);
-
-        // Apply settings
-        tcsetattr(serial_fd, TCSANOW, &options);
-
-        // Restore blocking behavior (read will wait for data)
-        fcntl(serial_fd, F_SETFL, 0);
-
         connected = true;
         return true;
     }
 
     bool closeConnection() {
-        if (connected && serial_fd != -1) {
-            close(serial_fd);
+        if (connected) {
+            link.close();
             connected = false;
-            serial_fd = -1;
             return true;
         }
         return false;
     }
 
-    // Send a single byte
-    void sendByte(unsigned char data) {
-        if (!connected) return;
-        write(serial_fd, &data, 1);
-    }
-    
-    // Receive a single byte
-    unsigned char readByte() {
-        if (!connected) return 0;
-        unsigned char buffer[1] = {0};
-        int n = read(serial_fd, buffer, 1);
-        if (n < 0) return 0; // Error
-        return buffer[0];
+    // Sends one framed request without waiting; returns its tag
+    unsigned char submitRequest(const vector<unsigned char> &commands) { return link.submit(commands); }
+
+    // Blocks until the reply for tag arrives (true) or the request gives up
+    bool awaitReply(unsigned char tag, vector<unsigned char> &reply) { return link.await(tag, reply); }
+
+    int getCrcErrors() { return link.getCrcErrors(); }
+    int getRetransmits() { return link.getRetransmits(); }
+    int getFailedRequests() { return link.getFailedRequests(); }
+
+    void setDeltaMode(bool enabled) {
+        deltaMode = enabled;
+        deltaSynced = false;
     }
-    
+
+    bool isDeltaMode() { return deltaMode; }
+    int getDeltaResyncs() { return deltaResyncs; }
+
     virtual void update() = 0; // Pure virtual
 };
 
@@ -118,20 +132,23 @@ public:
     AirConditionerSystemConnection() : desiredTemperature(0), ambientTemperature(0), fanSpeed(0) {}
 
     void update() override {
-        // [cite: 675] Example Protocol implementation
-        // Request Ambient Low Byte (0x03)
-        sendByte(0x03); 
-        int frac = readByte();
-        
-        // Request Ambient High Byte (0x04)
-        sendByte(0x04);
-        int integer = readByte();
-        
-        ambientTemperature = integer + (frac / 10.0f);
-        
-        // Request Fan Speed (0x05)
-        sendByte(0x05); 
-        fanSpeed = readByte();
+        if (deltaMode) {
+            pollDelta();
+            return;
+        }
+
+        // [cite: 675] Ambient Low/High Byte (0x03, 0x04) and Fan Speed (0x05),
+        // both requests in flight at once
+        unsigned char ambientTag = submitRequest({0x03, 0x04});
+        unsigned char fanTag = submitRequest({0x05});
+
+        vector<unsigned char> reply;
+        if (awaitReply(ambientTag, reply) && reply.size() == 2) {
+            ambientTemperature = reply[1] + (reply[0] / 10.0f);
+        }
+        if (awaitReply(fanTag, reply) && reply.size() == 1) {
+            fanSpeed = reply[0];
+        }
     }
 
     bool setDesiredTemp(float temp) {
@@ -141,16 +158,27 @@ public:
         int frac = (int)((temp - integer) * 10);
         
         unsigned char cmdInt = 0xC0 | (integer & 0x3F); 
-        sendByte(cmdInt);
-        
         unsigned char cmdFrac = 0x80 | (frac & 0x3F);   
-        sendByte(cmdFrac);
-        return true;
+
+        // Empty reply frame = acknowledged
+        vector<unsigned char> reply;
+        return awaitReply(submitRequest({cmdInt, cmdFrac}), reply);
     }
 
     float getAmbientTemp() { return ambientTemperature; }
     float getDesiredTemp() { return desiredTemperature; }
     int getFanSpeed() { return fanSpeed; }
+
+protected:
+    // Bits (Board1_AirConditioner.s): 0 Desired Int, 1 Ambient Int,
+    // 2 Fan Speed, 3 Desired Frac
+    void applyDeltaValue(int bit, unsigned char value) override {
+        float whole = floor(desiredTemperature);
+        if (bit == 0) desiredTemperature = value + (desiredTemperature - whole);
+        else if (bit == 1) ambientTemperature = value;
+        else if (bit == 2) fanSpeed = value;
+        else if (bit == 3) desiredTemperature = whole + value / 10.0f;
+    }
 };
 
 // ===========================================================================
@@ -162,24 +190,37 @@ private:
     // Additional vars omitted for brevity as per PDF structure
     
 public:
+    CurtainControlSystemConnection() : curtainStatus(0) {}
+
     void update() override {
+        if (deltaMode) {
+            pollDelta();
+            return;
+        }
+
         // [cite: 719] Request Curtain Status (simplified)
-        sendByte(0x01); // Get Low Byte
-        int frac = readByte();
-        sendByte(0x02); // Get High Byte
-        int integer = readByte();
-        curtainStatus = integer + (frac / 10.0f);
+        vector<unsigned char> reply;
+        if (awaitReply(submitRequest({0x01, 0x02}), reply) && reply.size() == 2) {
+            curtainStatus = reply[1] + (reply[0] / 10.0f); // Low Byte, High Byte
+        }
     }
 
     bool setCurtainStatus(float status) {
         // [cite: 719] Set Curtain Status
         int val = (int)status;
         unsigned char cmd = 0xC0 | (val & 0x3F); 
-        sendByte(cmd);
-        return true;
+        vector<unsigned char> reply;
+        return awaitReply(submitRequest({cmd}), reply);
     }
     
     float getCurtainStatus() { return curtainStatus; }
+
+protected:
+    // Bits (Board2_Curtain.s): 0 Curtain; outdoor temp, pressure and
+    // light (bits 1-3) are not shown by this client
+    void applyDeltaValue(int bit, unsigned char value) override {
+        if (bit == 0) curtainStatus = value;
+    }
 };
 
 // ===========================================================================
@@ -216,6 +257,10 @@ int main() {
         return 1;
     }
 
+    // Refresh with delta telemetry: only fields that changed cross the link
+    ac.setDeltaMode(true);
+    curtain.setDeltaMode(true);
+
     int choice = 0;
     while (choice != 3) {
         clearScreen();
@@ -0,0 +1,255 @@
+// ===========================================================================
+// Framed Serial Link (POSIX)
+// ---------------------------------------------------------------------------
+// Host side of the boards' framed UART protocol (uart_link.inc). Requests
+// are COBS frames delimited by 0x00:
+//   request: [tag] [command bytes...] [CRC-8]
+//   reply:   [tag] [reply bytes...]   [CRC-8]
+// CRC-8 is polynomial 0x07, initial value 0. The board answers in order,
+// so several tagged requests can be in flight; replies are matched back by
+// tag, corrupted frames are dropped and the request is resent (after
+// LINK_TIMEOUT_MS, or at once when a later tag is answered first).
+//
+//   FramedLink link;
+//   if (link.open("/tmp/ttyAC", 9600)) {
+//       vector<unsigned char> reply;
+//       if (link.request({0x03, 0x04}, reply)) ...   // ambient frac, int
+//   }
+// ===========================================================================
+#ifndef MICROFALL_LINK_H
+#define MICROFALL_LINK_H
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+const int LINK_MAX_FRAME = 16;          // Decoded frame limit (board rx_buf / reply_buf)
+const int LINK_MAX_ENCODED = LINK_MAX_FRAME + 1;    // COBS adds one code byte per 254
+const int LINK_MAX_COMMANDS = LINK_MAX_FRAME - 2;
+const int LINK_TIMEOUT_MS = 100;        // ~10 frames at 9600 baud
+const int LINK_MAX_ATTEMPTS = 3;
+
+class FramedLink {
+private:
+    struct PendingRequest {
+        std::vector<unsigned char> commands;
+        unsigned long order;            // Submission order
+        int attempts;
+        std::chrono::steady_clock::time_point sentAt;
+    };
+
+    int fd;
+    std::map<unsigned char, PendingRequest> pending;
+    std::map<unsigned char, std::vector<unsigned char>> completed;
+    std::vector<unsigned char> rxFrame; // Encoded bytes since the last 0x00
+    bool rxDiscard;                     // Oversized frame: skip to the next 0x00
+    unsigned char nextTag;
+    unsigned long submitCount;
+    int crcErrors;
+    int retransmits;
+    int failedRequests;
+
+    void sendFrame(unsigned char tag, const std::vector<unsigned char> &commands) {
+        std::vector<unsigned char> payload;
+        payload.push_back(tag);
+        payload.insert(payload.end(), commands.begin(), commands.end());
+        payload.push_back(crc8(payload));
+
+        // COBS: every zero becomes the length of the run before it
+        std::vector<unsigned char> out;
+        out.push_back(0x00);            // Leading delimiter discards line noise
+        size_t codeIndex = out.size();
+        out.push_back(0);
+        unsigned char code = 1;
+        for (unsigned char b : payload) {
+            if (b == 0) {
+                out[codeIndex] = code;
+                codeIndex = out.size();
+                out.push_back(0);
+                code = 1;
+            } else {
+                out.push_back(b);
+                if (++code == 0xFF) {
+                    out[codeIndex] = code;
+                    codeIndex = out.size();
+                    out.push_back(0);
+                    code = 1;
+                }
+            }
+        }
+        out[codeIndex] = code;
+        out.push_back(0x00);
+
+        if (fd != -1) write(fd, out.data(), out.size());
+    }
+
+    void retransmit(unsigned char tag, PendingRequest &req) {
+        req.attempts++;
+        req.sentAt = std::chrono::steady_clock::now();
+        retransmits++;
+        sendFrame(tag, req.commands);
+    }
+
+    void handleFrame(const std::vector<unsigned char> &encoded) {
+        std::vector<unsigned char> frame;
+        size_t i = 0;
+        while (i < encoded.size()) {
+            unsigned char code = encoded[i++];
+            for (int k = 1; k < code && i < encoded.size(); k++) frame.push_back(encoded[i++]);
+            if (code < 0xFF && i < encoded.size()) frame.push_back(0);
+        }
+        if (frame.size() < 2 || crc8(frame) != 0) {
+            crcErrors++;
+            return;
+        }
+
+        auto it = pending.find(frame[0]);
+        if (it == pending.end()) return;    // Duplicate of an answered retransmit
+        unsigned long order = it->second.order;
+        completed[frame[0]] = std::vector<unsigned char>(frame.begin() + 1, frame.end() - 1);
+        pending.erase(it);
+
+        // Fast retransmit: the board answers in order, so anything older
+        // that is still pending was lost on the way
+        for (auto &p : pending) {
+            if (p.second.order < order) retransmit(p.first, p.second);
+        }
+    }
+
+public:
+    FramedLink() : fd(-1), rxDiscard(false), nextTag(0), submitCount(0),
+        crcErrors(0), retransmits(0), failedRequests(0) {}
+    ~FramedLink() { close(); }
+
+    static unsigned char crc8(const std::vector<unsigned char> &data) {
+        unsigned char crc = 0;
+        for (unsigned char b : data) {
+            crc ^= b;
+            for (int i = 0; i < 8; i++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+        }
+        return crc;
+    }
+
+    // Opens the port raw 8N1 (no line buffering, echo or CR/LF translation)
+    bool open(const std::string &path, int baudRate) {
+        close();
+        fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NDELAY);
+        if (fd == -1) return false;
+
+        struct termios options;
+        tcgetattr(fd, &options);
+        speed_t speed;
+        switch (baudRate) {
+            case 19200: speed = B19200; break;
+            case 115200: speed = B115200; break;
+            default: speed = B9600;
+        }
+        cfsetispeed(&options, speed);
+        cfsetospeed(&options, speed);
+        options.c_cflag &= ~(PARENB | CSTOPB | CSIZE | CRTSCTS);
+        options.c_cflag |= CS8 | CLOCAL | CREAD;
+        options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
+        options.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | INLCR | IGNCR);
+        options.c_oflag &= ~OPOST;
+        tcsetattr(fd, TCSANOW, &options);
+
+        fcntl(fd, F_SETFL, 0);          // Blocking; pump() polls before reading
+        return true;
+    }
+
+    void close() {
+        if (fd != -1) ::close(fd);
+        fd = -1;
+        pending.clear();
+        completed.clear();
+        rxFrame.clear();
+        rxDiscard = false;
+    }
+
+    bool isOpen() const { return fd != -1; }
+
+    // Sends one framed request without waiting; returns its tag
+    unsigned char submit(const std::vector<unsigned char> &commands) {
+        while (pending.count(nextTag) || completed.count(nextTag)) nextTag++;
+        unsigned char tag = nextTag++;
+        PendingRequest &req = pending[tag];
+        req.commands = commands;
+        req.order = submitCount++;
+        req.attempts = 1;
+        req.sentAt = std::chrono::steady_clock::now();
+        sendFrame(tag, commands);
+        return tag;
+    }
+
+    // Reads whatever arrives within timeoutMs and retransmits timed-out
+    // requests. Returns false if nothing was received.
+    bool pump(int timeoutMs) {
+        if (fd == -1) return false;
+        bool received = false;
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (poll(&pfd, 1, timeoutMs) > 0 && (pfd.revents & POLLIN)) {
+            unsigned char buffer[64];
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            for (ssize_t i = 0; i < n; i++) {
+                if (buffer[i] == 0x00) {
+                    if (!rxFrame.empty() && !rxDiscard) handleFrame(rxFrame);
+                    rxFrame.clear();
+                    rxDiscard = false;
+                } else if (rxFrame.size() >= (size_t)LINK_MAX_ENCODED) {
+                    // Longer than any valid encoded frame: noise
+                    if (!rxDiscard) crcErrors++;
+                    rxDiscard = true;
+                } else {
+                    rxFrame.push_back(buffer[i]);
+                }
+            }
+            received = n > 0;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (now - it->second.sentAt < std::chrono::milliseconds(LINK_TIMEOUT_MS)) {
+                ++it;
+            } else if (it->second.attempts < LINK_MAX_ATTEMPTS) {
+                retransmit(it->first, it->second);
+                ++it;
+            } else {
+                failedRequests++;
+                it = pending.erase(it);
+            }
+        }
+        return received;
+    }
+
+    // Blocks until the reply for tag arrives (true) or the request gives up
+    bool await(unsigned char tag, std::vector<unsigned char> &reply) {
+        while (true) {
+            auto it = completed.find(tag);
+            if (it != completed.end()) {
+                reply = it->second;
+                completed.erase(it);
+                return true;
+            }
+            if (!pending.count(tag)) return false;
+            pump(10);
+        }
+    }
+
+    // submit() + await(); false if the commands do not fit one frame
+    bool request(const std::vector<unsigned char> &commands, std::vector<unsigned char> &reply) {
+        if (commands.empty() || commands.size() > (size_t)LINK_MAX_COMMANDS) return false;
+        return await(submit(commands), reply);
+    }
+
+    int getCrcErrors() const { return crcErrors; }
+    int getRetransmits() const { return retransmits; }
+    int getFailedRequests() const { return failedRequests; }
+};
+
+#endif
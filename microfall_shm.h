@@ -0,0 +1,270 @@
+// ===========================================================================
+// Shared-Memory Board State (POSIX)
+// ---------------------------------------------------------------------------
+// The host application publishes every board's latest field values into one
+// POSIX shared-memory segment. Each board slot is guarded by a seqlock:
+// the writer makes the sequence odd while it updates and even when done, and
+// readers retry if the sequence changed underneath them. A read is a handful
+// of plain loads: no syscalls, no locks, no UART traffic.
+//
+// Writer side: open(), addBoard() for every board, then ready(). Readers
+// only see the segment after ready(), so the board table never changes
+// underneath them. Only one writer at a time: open() fails while another
+// writer is alive and replaces the segment of one that crashed. attach()
+// refuses a segment whose writer process is gone; long-running readers
+// can poll isWriterAlive().
+//
+// Reader side:
+//   StateReader state;
+//   if (state.attach()) {
+//       double light;
+//       if (state.read("curtain.light", light)) ...
+//   }
+// ===========================================================================
+#ifndef MICROFALL_SHM_H
+#define MICROFALL_SHM_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* const STATE_SEGMENT_NAME = "/microfall_state";
+const uint32_t STATE_MAGIC = 0x4D464C31; // "MFL1"
+
+const int STATE_MAX_BOARDS = 4;
+const int STATE_MAX_FIELDS = 8;
+const int STATE_NAME_LEN = 24;
+const int STATE_READ_RETRIES = 1000;    // Tight spins before yielding to the writer
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seqlock needs lock-free atomics");
+static_assert(std::atomic<double>::is_always_lock_free, "seqlock needs lock-free atomics");
+
+struct BoardState {
+    std::atomic<uint32_t> seq;              // Odd while the writer is updating
+    uint32_t fieldCount;
+    char names[STATE_MAX_FIELDS][STATE_NAME_LEN];
+    std::atomic<double> values[STATE_MAX_FIELDS];
+    std::atomic<uint64_t> updateCount;      // Number of publishes
+    std::atomic<int64_t> updatedAtNs;       // CLOCK_REALTIME of last publish
+};
+
+struct StateSegment {
+    std::atomic<uint32_t> magic;            // STATE_MAGIC once ready()
+    uint32_t boardCount;
+    std::atomic<int32_t> writerPid;         // -1 while a new writer takes over
+    BoardState boards[STATE_MAX_BOARDS];
+};
+
+// Plain copy of one board, as returned by StateReader
+struct BoardSnapshot {
+    uint32_t fieldCount;
+    double values[STATE_MAX_FIELDS];
+    uint64_t updateCount;
+    int64_t updatedAtNs;
+};
+
+// Process still running (one kill(pid, 0) syscall)
+inline bool isProcessAlive(int32_t pid) {
+    if (pid <= 0) return false;
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+// --- Writer (host application) ---
+class StatePublisher {
+private:
+    StateSegment* segment;
+
+    // Existing segment: unlinks it if its writer is dead. The pid swap
+    // makes sure only one new writer takes over; a segment still being
+    // created (short, or pid 0) counts as live.
+    static bool claimStaleSegment() {
+        int fd = shm_open(STATE_SEGMENT_NAME, O_RDWR, 0);
+        if (fd == -1) return errno == ENOENT;   // Already gone: create again
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(StateSegment)) {
+            p = mmap(nullptr, sizeof(StateSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+
+        StateSegment* old = static_cast<StateSegment*>(p);
+        int32_t pid = old->writerPid.load(std::memory_order_acquire);
+        bool claimed = pid > 0 && !isProcessAlive(pid) &&
+            old->writerPid.compare_exchange_strong(pid, -1, std::memory_order_acq_rel);
+        munmap(p, sizeof(StateSegment));
+        if (claimed) unlinkSegment();
+        return claimed;
+    }
+
+public:
+    StatePublisher() : segment(nullptr) {}
+    ~StatePublisher() { close(); }
+
+    // False if another writer is running. A fresh segment is zero-filled,
+    // so readers attached to a replaced one keep their old mapping.
+    bool open() {
+        int fd = shm_open(STATE_SEGMENT_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd == -1 && errno == EEXIST && claimStaleSegment()) {
+            fd = shm_open(STATE_SEGMENT_NAME, O_CREAT | O_EXCL | O_RDWR, 0644);
+        }
+        if (fd == -1) return false;
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, sizeof(StateSegment)) == 0) {
+            p = mmap(nullptr, sizeof(StateSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            unlinkSegment();
+            return false;
+        }
+
+        segment = static_cast<StateSegment*>(p);
+        segment->writerPid.store(getpid(), std::memory_order_release);
+        return true;
+    }
+
+    void close() {
+        if (!segment) return;
+        munmap(segment, sizeof(StateSegment));
+        unlinkSegment();
+        segment = nullptr;
+    }
+
+    // Also safe from a signal handler (Ctrl-C) so the segment does not
+    // outlive the writer
+    static void unlinkSegment() { shm_unlink(STATE_SEGMENT_NAME); }
+
+    // Registers a board slot before ready(); returns its index or -1
+    int addBoard(const std::string* names, int count) {
+        if (!segment || segment->magic.load(std::memory_order_relaxed) == STATE_MAGIC) return -1;
+        if (segment->boardCount >= (uint32_t)STATE_MAX_BOARDS) return -1;
+        int index = segment->boardCount;
+        BoardState &b = segment->boards[index];
+        b.fieldCount = count < STATE_MAX_FIELDS ? count : STATE_MAX_FIELDS;
+        for (uint32_t i = 0; i < b.fieldCount; i++) {
+            strncpy(b.names[i], names[i].c_str(), STATE_NAME_LEN - 1);
+        }
+        segment->boardCount++;
+        return index;
+    }
+
+    // Called once all boards are added. Magic last: readers treat the
+    // segment as valid from here on.
+    void ready() {
+        if (segment) segment->magic.store(STATE_MAGIC, std::memory_order_release);
+    }
+
+    void publish(int board, const double* values, int count) {
+        if (!segment || board < 0) return;
+        BoardState &b = segment->boards[board];
+        if (count > (int)b.fieldCount) count = b.fieldCount;
+
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+
+        uint32_t s = b.seq.load(std::memory_order_relaxed);
+        b.seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < count; i++) b.values[i].store(values[i], std::memory_order_relaxed);
+        b.updateCount.store(b.updateCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        b.updatedAtNs.store((int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec, std::memory_order_relaxed);
+        b.seq.store(s + 2, std::memory_order_release);
+    }
+};
+
+// --- Reader (any local process) ---
+class StateReader {
+private:
+    const StateSegment* segment;
+
+public:
+    StateReader() : segment(nullptr) {}
+    ~StateReader() { detach(); }
+
+    bool attach() {
+        int fd = shm_open(STATE_SEGMENT_NAME, O_RDONLY, 0);
+        if (fd == -1) return false;
+        void* p = mmap(nullptr, sizeof(StateSegment), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        segment = static_cast<const StateSegment*>(p);
+        if (!isWriterAlive()) {
+            detach();
+            return false;
+        }
+        return true;
+    }
+
+    void detach() {
+        if (segment) munmap(const_cast<StateSegment*>(segment), sizeof(StateSegment));
+        segment = nullptr;
+    }
+
+    bool isValid() const {
+        return segment && segment->magic.load(std::memory_order_acquire) == STATE_MAGIC;
+    }
+
+    // Writer process still running (one kill(pid, 0) syscall)
+    bool isWriterAlive() const {
+        return segment && isProcessAlive(segment->writerPid.load(std::memory_order_relaxed));
+    }
+
+    int getBoardCount() const { return isValid() ? (int)segment->boardCount : 0; }
+
+    // Consistent copy of one board. Retries while the writer is
+    // mid-update, yielding once the spins run out (it may just be
+    // preempted); false only if the writer died mid-publish.
+    bool readBoard(int board, BoardSnapshot &out) const {
+        if (board < 0 || board >= getBoardCount()) return false;
+        const BoardState &b = segment->boards[board];
+        out.fieldCount = b.fieldCount;
+
+        for (int attempt = 1; ; attempt++) {
+            uint32_t s1 = b.seq.load(std::memory_order_acquire);
+            if (!(s1 & 1)) {
+                for (uint32_t i = 0; i < out.fieldCount; i++) {
+                    out.values[i] = b.values[i].load(std::memory_order_relaxed);
+                }
+                out.updateCount = b.updateCount.load(std::memory_order_relaxed);
+                out.updatedAtNs = b.updatedAtNs.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (b.seq.load(std::memory_order_relaxed) == s1) return true;
+            }
+            if (attempt >= STATE_READ_RETRIES) {
+                if (!isWriterAlive()) return false;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Looks a field up by name ("ac.ambient", "curtain.light", ...)
+    bool read(const std::string &name, double &value) const {
+        for (int board = 0; board < getBoardCount(); board++) {
+            const BoardState &b = segment->boards[board];
+            for (uint32_t i = 0; i < b.fieldCount; i++) {
+                if (name == b.names[i]) {
+                    BoardSnapshot snap;
+                    if (!readBoard(board, snap)) return false;
+                    value = snap.values[i];
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    int getWriterPid() const { return isValid() ? segment->writerPid.load(std::memory_order_relaxed) : 0; }
+};
+
+#endif
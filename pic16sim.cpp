@@ -0,0 +1,365 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+
+// POSIX pseudo-terminal headers (Linux / macOS)
+#include <fcntl.h>
+#include <errno.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "pic16sim.h"
+
+using namespace std;
+
+// ===========================================================================
+// Headless board runner
+// ---------------------------------------------------------------------------
+// Loads a board .hex into PIC16F877A and exposes its USART as a pseudo
+// terminal. Point the host application (macos.cpp) at the printed slave path
+// instead of a PICSimLab virtual COM port.
+//
+//   ./pic16sim Board1_AirConditioner.hex --link /tmp/ttyAC --an 0=512
+//   ./pic16sim --self-test
+// ===========================================================================
+
+static volatile sig_atomic_t stopRequested = 0;
+static void onSignal(int) { stopRequested = 1; }
+
+class PtyBridge {
+private:
+    int masterFd;
+    int slaveFd;    // Held open so the master never sees EOF between host runs
+    string slavePath;
+    string linkPath;
+
+public:
+    PtyBridge() : masterFd(-1), slaveFd(-1) {}
+    ~PtyBridge() { closeBridge(); }
+
+    bool openBridge(const string &link) {
+        masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (masterFd == -1) {
+            perror("posix_openpt");
+            return false;
+        }
+        if (grantpt(masterFd) != 0 || unlockpt(masterFd) != 0) {
+            perror("grantpt/unlockpt");
+            return false;
+        }
+        slavePath = ptsname(masterFd);
+
+        // Raw 8N1 on the slave side, exactly like a serial port
+        slaveFd = open(slavePath.c_str(), O_RDWR | O_NOCTTY);
+        if (slaveFd == -1) {
+            perror("Unable to open pty slave");
+            return false;
+        }
+        struct termios options;
+        tcgetattr(slaveFd, &options);
+        cfmakeraw(&options);
+        cfsetispeed(&options, B9600);
+        cfsetospeed(&options, B9600);
+        tcsetattr(slaveFd, TCSANOW, &options);
+
+        fcntl(masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK);
+
+        if (!link.empty()) {
+            unlink(link.c_str());
+            if (symlink(slavePath.c_str(), link.c_str()) != 0) {
+                perror("symlink");
+                return false;
+            }
+            linkPath = link;
+        }
+        return true;
+    }
+
+    void closeBridge() {
+        if (!linkPath.empty()) unlink(linkPath.c_str());
+        if (slaveFd != -1) close(slaveFd);
+        if (masterFd != -1) close(masterFd);
+        slaveFd = masterFd = -1;
+        linkPath.clear();
+    }
+
+    // Move bytes in both directions without blocking. Returns true if any
+    // traffic was seen.
+    bool pump(PIC16F877A &mcu) {
+        bool active = false;
+        unsigned char buffer[256];
+        ssize_t n;
+        while ((n = read(masterFd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t i = 0; i < n; i++) mcu.uartReceive(buffer[i]);
+            active = true;
+        }
+
+        uint8_t b;
+        vector<unsigned char> out;
+        while (mcu.uartTransmitted(b)) out.push_back(b);
+        if (!out.empty()) {
+            write(masterFd, out.data(), out.size());
+            active = true;
+        }
+        return active;
+    }
+
+    const string &getSlavePath() const { return slavePath; }
+};
+
+// ---------------------------------------------------------------------------
+// Self-test: small programs built in memory with loadWords(), checked
+// against the datasheet (flags, skips, computed goto, Timer0 interrupt,
+// USART timing at 9600 baud / 4 MHz)
+// ---------------------------------------------------------------------------
+
+// Instruction encodings (datasheet table 15-2); d = 1 stores to f
+namespace enc {
+    uint16_t addwf(int f, int d) { return 0x0700 | d << 7 | f; }
+    uint16_t subwf(int f, int d) { return 0x0200 | d << 7 | f; }
+    uint16_t incf(int f, int d) { return 0x0A00 | d << 7 | f; }
+    uint16_t decfsz(int f, int d) { return 0x0B00 | d << 7 | f; }
+    uint16_t movf(int f, int d) { return 0x0800 | d << 7 | f; }
+    uint16_t movwf(int f) { return 0x0080 | f; }
+    uint16_t clrf(int f) { return 0x0180 | f; }
+    uint16_t bcf(int f, int b) { return 0x1000 | b << 7 | f; }
+    uint16_t bsf(int f, int b) { return 0x1400 | b << 7 | f; }
+    uint16_t btfsc(int f, int b) { return 0x1800 | b << 7 | f; }
+    uint16_t btfss(int f, int b) { return 0x1C00 | b << 7 | f; }
+    uint16_t call(int k) { return 0x2000 | k; }
+    uint16_t gotoK(int k) { return 0x2800 | k; }
+    uint16_t movlw(int k) { return 0x3000 | k; }
+    uint16_t retlw(int k) { return 0x3400 | k; }
+    uint16_t addlw(int k) { return 0x3E00 | k; }
+    uint16_t sublw(int k) { return 0x3C00 | k; }
+    const uint16_t retfie = 0x0009;
+}
+
+static int selfTestFailures = 0;
+
+static void check(const char *name, bool ok) {
+    if (!ok) {
+        cout << "FAIL: " << name << endl;
+        selfTestFailures++;
+    }
+}
+
+static void load(PIC16F877A &mcu, const vector<uint16_t> &words, int origin = 0) {
+    mcu.loadWords(words.data(), (int)words.size(), origin);
+}
+
+static bool selfTest() {
+    using namespace enc;
+    typedef PIC16F877A P;
+    const int flags = (1 << P::C) | (1 << P::DC) | (1 << P::Z);
+
+    {   // ALU flags: each STATUS is copied to 0x30.. right after the operation
+        P mcu;
+        load(mcu, {
+            movlw(0x0F), movwf(0x20), movlw(0x01), addwf(0x20, 1),  // 0x0F + 1
+            movf(P::STATUS, 0), movwf(0x30),
+            movlw(0xFF), movwf(0x21), movlw(0x01), addwf(0x21, 1),  // 0xFF + 1
+            movf(P::STATUS, 0), movwf(0x31),
+            movlw(0x05), movwf(0x22), movlw(0x06), subwf(0x22, 1),  // 5 - 6
+            movf(P::STATUS, 0), movwf(0x32),
+            movlw(0x10), sublw(0x10), movwf(0x23),                  // 0x10 - 0x10
+            movf(P::STATUS, 0), movwf(0x33),
+            movlw(0x08), addlw(0x07), movwf(0x24),                  // 0x08 + 0x07
+            movf(P::STATUS, 0), movwf(0x34),
+            gotoK(28)
+        });
+        mcu.runCycles(50);
+        check("ADDWF 0x0F+1 = 0x10, DC only", mcu.peek(0x20) == 0x10 && (mcu.peek(0x30) & flags) == 1 << P::DC);
+        check("ADDWF 0xFF+1 = 0, C DC Z", mcu.peek(0x21) == 0x00 && (mcu.peek(0x31) & flags) == flags);
+        check("SUBWF 5-6 = 0xFF, borrow (C=0, DC=0)", mcu.peek(0x22) == 0xFF && (mcu.peek(0x32) & flags) == 0);
+        check("SUBLW 0x10-0x10 = 0, C DC Z", mcu.peek(0x23) == 0x00 && (mcu.peek(0x33) & flags) == flags);
+        check("ADDLW 0x08+0x07 = 0x0F, no flags", mcu.peek(0x24) == 0x0F && (mcu.peek(0x34) & flags) == 0);
+    }
+
+    {   // Skips: DECFSZ loop runs 3 times, taken skips cost 2 cycles
+        P mcu;
+        load(mcu, {
+            movlw(3), movwf(0x20),
+            incf(0x21, 1), decfsz(0x20, 1), gotoK(2),
+            bsf(0x22, 0),
+            btfss(0x22, 0), bsf(0x23, 0),       // Set: skipped
+            btfsc(0x22, 1), bsf(0x23, 1),       // Clear: skipped
+            bsf(0x23, 7),
+            gotoK(11)
+        });
+        mcu.runCycles(19);                      // 2 + 4 + 4 + 3 + 1 + 2 + 2 + 1
+        check("DECFSZ loop count", mcu.peek(0x21) == 3);
+        check("BTFSS/BTFSC skip", mcu.peek(0x23) == 0x80);
+        check("skip timing (19 cycles to 0x0B)", mcu.getPC() == 11 && mcu.getCycles() == 19);
+    }
+
+    {   // Computed goto: ADDWF PCL with PCLATH = 1, table at 0x100
+        P mcu;
+        load(mcu, {
+            movlw(0x01), movwf(P::PCLATH), movlw(2), call(0x100),
+            movwf(0x20), gotoK(5)
+        });
+        load(mcu, { addwf(P::PCL, 1), retlw(0xA0), retlw(0xA1), retlw(0xA2) }, 0x100);
+        mcu.runCycles(10);                      // 1 + 1 + 1 + 2 + 2 + 2 + 1
+        check("ADDWF PCL table entry", mcu.peek(0x20) == 0xA2);
+        check("ADDWF PCL timing (10 cycles to 0x05)", mcu.getPC() == 5 && mcu.getCycles() == 10);
+    }
+
+    {   // Timer0 at 1:8 overflows every 2048 cycles; the ISR at 0x04 counts
+        P mcu;
+        load(mcu, {
+            gotoK(0x10), 0, 0, 0,
+            incf(0x20, 1), bcf(P::INTCON, P::T0IF), retfie
+        });
+        load(mcu, {
+            bsf(P::STATUS, P::RP0), movlw(0x02), movwf(P::OPTION_REG & 0x7F),
+            bcf(P::STATUS, P::RP0), clrf(P::TMR0),
+            movlw(1 << P::GIE | 1 << P::T0IE), movwf(P::INTCON),
+            gotoK(0x17)
+        }, 0x10);
+        mcu.runCycles(2000);
+        check("Timer0 no interrupt before overflow", mcu.peek(0x20) == 0);
+        mcu.runUntil(3 * 2048 + 100);
+        check("Timer0 interrupt every 2048 cycles", mcu.peek(0x20) == 3);
+        check("RETFIE restores GIE, ISR clears T0IF",
+              (mcu.peek(P::INTCON) & (1 << P::GIE | 1 << P::T0IF)) == 1 << P::GIE);
+    }
+
+    {   // USART: echo RX + 1 at 9600 baud (BRGH = 1, SPBRG = 25: 1040 cycles a byte)
+        P mcu;
+        load(mcu, {
+            bsf(P::STATUS, P::RP0), movlw(25), movwf(P::SPBRG & 0x7F),
+            movlw(1 << P::TXEN | 1 << P::BRGH), movwf(P::TXSTA & 0x7F),
+            bcf(P::STATUS, P::RP0), movlw(1 << P::SPEN | 1 << P::CREN), movwf(P::RCSTA),
+            btfss(P::PIR1, P::RCIF), gotoK(8),
+            movf(P::RCREG, 0), addlw(1), movwf(P::TXREG), gotoK(8)
+        });
+        mcu.runCycles(20);
+        uint64_t start = mcu.getCycles();
+        mcu.uartReceive(0x41);
+        uint8_t b = 0;
+        mcu.runUntil(start + 1030);
+        check("USART RX not complete before 10 bit times", !(mcu.peek(P::PIR1) & (1 << P::RCIF)));
+        mcu.runUntil(start + 2080);
+        check("USART TX not complete before 10 more bit times", !mcu.uartTransmitted(b));
+        mcu.runUntil(start + 2100);
+        check("USART echo after 2 bytes on the line", mcu.uartTransmitted(b) && b == 0x42);
+    }
+
+    cout << "self-test: " << (selfTestFailures ? "FAILED" : "ok") << endl;
+    return selfTestFailures == 0;
+}
+
+static void usage(const char *argv0) {
+    cout << "Usage: " << argv0 << " <firmware.hex> [options]\n"
+         << "       " << argv0 << " --self-test\n"
+         << "  --fosc <hz>          Oscillator frequency (default 4000000)\n"
+         << "  --link <path>        Create a symlink to the pty slave\n"
+         << "  --an <ch>=<value>    Analog input in ADC counts (0-1023)\n"
+         << "  --input <port>=<v>   Input pin levels, e.g. B=0xEF\n"
+         << "  --speed <x>          Throttle to x times real time (0 = unlimited)\n"
+         << "  --seconds <s>        Stop after s simulated seconds\n";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 2 && string(argv[1]) == "--self-test") return selfTest() ? 0 : 1;
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    string hexPath = argv[1];
+    uint32_t fosc = 4000000;
+    string link;
+    double speed = 0;
+    double limitSeconds = 0;
+    vector<pair<int, uint16_t>> analog;
+    vector<pair<int, uint8_t>> inputs;
+
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        string val = argv[++i];
+        size_t eq = val.find('=');
+        bool ok = true;
+
+        try {
+            if (arg == "--fosc") fosc = stoul(val);
+            else if (arg == "--link") link = val;
+            else if (arg == "--speed") speed = stod(val);
+            else if (arg == "--seconds") limitSeconds = stod(val);
+            else if (arg == "--an" && eq != string::npos) {
+                int ch = stoi(val.substr(0, eq));
+                unsigned long v = stoul(val.substr(eq + 1), nullptr, 0);
+                ok = ch >= 0 && ch < 8 && v <= 1023;
+                analog.push_back({ch, (uint16_t)v});
+            } else if (arg == "--input" && eq == 1) {
+                int port = toupper(val[0]) - 'A';
+                unsigned long v = stoul(val.substr(2), nullptr, 0);
+                ok = port >= 0 && port < 5 && v <= 0xFF;
+                inputs.push_back({port, (uint8_t)v});
+            } else {
+                ok = false;
+            }
+        } catch (const exception &) {   // invalid_argument / out_of_range
+            ok = false;
+        }
+        if (!ok || fosc == 0) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    PIC16F877A mcu(fosc);
+    if (!mcu.loadHex(hexPath)) {
+        cout << "Failed to load " << hexPath << endl;
+        return 1;
+    }
+    for (auto &a : analog) mcu.setAnalog(a.first, a.second);
+    for (auto &p : inputs) mcu.setPortInput(p.first, p.second);
+
+    PtyBridge bridge;
+    if (!bridge.openBridge(link)) return 1;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    cout << "UART on " << bridge.getSlavePath();
+    if (!link.empty()) cout << " (" << link << ")";
+    cout << endl;
+
+    // Run in 1 ms slices of simulated time; the pty is serviced between
+    // slices, which is well under one 9600-baud character (~1.04 ms).
+    const uint64_t slice = fosc / 4 / 1000;
+    const uint64_t limitCycles = (uint64_t)(limitSeconds * fosc / 4);
+    auto start = chrono::steady_clock::now();
+
+    while (!stopRequested) {
+        bridge.pump(mcu);
+        mcu.runCycles(slice);
+        if (limitCycles && mcu.getCycles() >= limitCycles) break;
+
+        if (speed > 0) {
+            auto target = start + chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(mcu.getSimSeconds() / speed));
+            this_thread::sleep_until(target);
+        }
+    }
+    bridge.pump(mcu);
+
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double sim = mcu.getSimSeconds();
+    fprintf(stderr, "simulated %.3f s in %.3f s (%.1fx real time, %.1f MIPS)\n",
+            sim, wall, wall > 0 ? sim / wall : 0.0,
+            wall > 0 ? mcu.getInstructions() / wall / 1e6 : 0.0);
+    return 0;
+}
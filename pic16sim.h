@@ -0,0 +1,731 @@
+// ===========================================================================
+// PIC16F877A Instruction-Set Simulator
+// ---------------------------------------------------------------------------
+// Host-side model of the board MCU so Board1_AirConditioner.s and
+// Board2_Curtain.s can run headless (no PICSimLab). Program memory is
+// pre-decoded once at load time; the run loop dispatches on the decoded
+// opcode instead of re-parsing 14-bit words every cycle.
+//
+// Modelled: full 35-instruction core, 4 RAM banks with SFR/GPR mirroring,
+// 8-level stack, Timer0 (+prescaler), ADC (AN0-AN7), async USART and the
+// interrupt vector at 0x0004. Not modelled: Timer1/2, CCP, MSSP, EEPROM and
+// self-programming, watchdog.
+// ===========================================================================
+#ifndef PIC16SIM_H
+#define PIC16SIM_H
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <string>
+
+class PIC16F877A {
+public:
+    // --- SFR addresses (bank 0 / bank 1 canonical) ---
+    enum {
+        INDF = 0x00, TMR0 = 0x01, PCL = 0x02, STATUS = 0x03, FSR = 0x04,
+        PORTA = 0x05, PORTB = 0x06, PORTC = 0x07, PORTD = 0x08, PORTE = 0x09,
+        PCLATH = 0x0A, INTCON = 0x0B, PIR1 = 0x0C,
+        RCSTA = 0x18, TXREG = 0x19, RCREG = 0x1A, ADRESH = 0x1E, ADCON0 = 0x1F,
+        OPTION_REG = 0x81, TRISA = 0x85, PIE1 = 0x8C,
+        TXSTA = 0x98, SPBRG = 0x99, ADRESL = 0x9E, ADCON1 = 0x9F
+    };
+
+    // --- Bit positions used by the core ---
+    enum {
+        C = 0, DC = 1, Z = 2, PD = 3, TO = 4, RP0 = 5, IRP = 7,     // STATUS
+        INTF = 1, T0IF = 2, T0IE = 5, PEIE = 6, GIE = 7,            // INTCON
+        TXIF = 4, RCIF = 5, ADIF = 6,                               // PIR1/PIE1
+        GO = 2, ADON = 0,                                           // ADCON0
+        TRMT = 1, BRGH = 2, TXEN = 5,                               // TXSTA
+        OERR = 1, CREN = 4, SPEN = 7                                // RCSTA
+    };
+
+    static const int PROGRAM_WORDS = 0x2000;
+    static const int RAM_SIZE = 0x200;
+
+    PIC16F877A(uint32_t oscHz = 4000000) : fosc(oscHz) {
+        buildBankMap();
+        memset(program, 0, sizeof(program));
+        for (int i = 0; i < PROGRAM_WORDS; i++) decoded[i] = decode(0);
+        for (int i = 0; i < 8; i++) analogIn[i] = 0;
+        reset();
+    }
+
+    // -----------------------------------------------------------------------
+    // Program loading
+    // -----------------------------------------------------------------------
+
+    // Load an Intel HEX image as produced by pic-as / MPLAB (byte address =
+    // 2 * word address, little-endian words). Config/EEPROM records are
+    // skipped. Returns false on a malformed file.
+    bool loadHex(const std::string &path) {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        uint32_t upper = 0;
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (line.empty()) continue;
+            if (line[0] != ':' || line.size() < 11 || line.size() % 2 == 0) return false;
+
+            uint8_t rec[260];
+            size_t n = (line.size() - 1) / 2;
+            if (n > sizeof(rec)) return false;
+            uint8_t sum = 0;
+            for (size_t i = 0; i < n; i++) {
+                int hi = hexDigit(line[1 + i * 2]);
+                int lo = hexDigit(line[2 + i * 2]);
+                if (hi < 0 || lo < 0) return false;
+                rec[i] = (uint8_t)(hi << 4 | lo);
+                sum += rec[i];
+            }
+            if (sum != 0 || n < (size_t)rec[0] + 5) return false;
+
+            uint8_t len = rec[0];
+            uint32_t addr = upper | (rec[1] << 8 | rec[2]);
+            uint8_t type = rec[3];
+
+            if (type == 0x00) {
+                for (int i = 0; i + 1 < len; i += 2) {
+                    uint32_t word = (addr + i) / 2;
+                    if (word < PROGRAM_WORDS) {
+                        program[word] = (rec[4 + i] | (rec[5 + i] << 8)) & 0x3FFF;
+                    }
+                }
+            } else if (type == 0x01) {
+                break;
+            } else if (type == 0x04) {
+                upper = (uint32_t)(rec[4] << 8 | rec[5]) << 16;
+            }
+        }
+
+        for (int i = 0; i < PROGRAM_WORDS; i++) decoded[i] = decode(program[i]);
+        return true;
+    }
+
+    // Load raw words directly at origin (the in-memory programs of
+    // pic16sim --self-test).
+    void loadWords(const uint16_t *words, int count, int origin = 0) {
+        for (int i = 0; i < count && origin + i < PROGRAM_WORDS; i++) {
+            program[origin + i] = words[i] & 0x3FFF;
+            decoded[origin + i] = decode(program[origin + i]);
+        }
+    }
+
+    // Power-on reset state (datasheet table 4-1, simplified).
+    void reset() {
+        memset(ram, 0, sizeof(ram));
+        ram[STATUS] = 0x18;             // TO=1, PD=1
+        ram[OPTION_REG] = 0xFF;
+        ram[TRISA] = 0x3F;
+        for (int i = 1; i < 5; i++) ram[TRISA + i] = 0xFF;
+        ram[TRISA + 4] = 0x07;          // TRISE
+        ram[TXSTA] = 1 << TRMT;
+        ram[PIR1] = 1 << TXIF;
+        for (int i = 0; i < 5; i++) { latch[i] = 0; pinIn[i] = 0xFF; }
+
+        w = 0;
+        pc = 0;
+        sp = 0;
+        cycles = 0;
+        instructions = 0;
+        sleeping = false;
+        prescaleCount = 0;
+        tmr0Period = 1;
+        updateTimer0Config();
+
+        adcDoneAt = 0;
+        adcBusy = false;
+        txBusy = false;
+        txPending = false;
+        txDoneAt = 0;
+        rxFifo.clear();
+        rxNextAt = 0;
+        rxLine.clear();
+        txLine.clear();
+        nextEvent = UINT64_MAX;
+    }
+
+    // -----------------------------------------------------------------------
+    // Host-side I/O
+    // -----------------------------------------------------------------------
+
+    // Queue bytes arriving on RC7/RX. They are shifted in at the configured
+    // baud rate in simulated time.
+    void uartReceive(uint8_t b) {
+        rxLine.push_back(b);
+        if (rxNextAt == 0 || rxNextAt < cycles) rxNextAt = cycles + charCycles();
+        scheduleNext();
+    }
+
+    // Bytes the firmware has finished shifting out on RC6/TX.
+    bool uartTransmitted(uint8_t &b) {
+        if (txLine.empty()) return false;
+        b = txLine.front();
+        txLine.pop_front();
+        return true;
+    }
+
+    // Analog inputs in ADC counts (0-1023).
+    void setAnalog(int channel, uint16_t value) {
+        if (channel >= 0 && channel < 8) analogIn[channel] = value & 0x3FF;
+    }
+
+    // External levels on input pins (port index 0 = PORTA ... 4 = PORTE).
+    void setPortInput(int port, uint8_t value) {
+        if (port >= 0 && port < 5) pinIn[port] = value;
+    }
+
+    // Pin levels as seen from outside (output latches merged with inputs).
+    uint8_t getPort(int port) const {
+        uint8_t tris = ram[TRISA + port];
+        return (latch[port] & ~tris) | (pinIn[port] & tris);
+    }
+
+    uint8_t getW() const { return w; }
+    uint16_t getPC() const { return pc; }
+    uint8_t peek(uint16_t addr) const { return ram[bankMap[addr & 0x1FF]]; }
+    void poke(uint16_t addr, uint8_t v) { ram[bankMap[addr & 0x1FF]] = v; }
+    uint64_t getCycles() const { return cycles; }
+    uint64_t getInstructions() const { return instructions; }
+    uint32_t getFosc() const { return fosc; }
+    double getSimSeconds() const { return cycles * 4.0 / fosc; }
+
+    // -----------------------------------------------------------------------
+    // Execution
+    // -----------------------------------------------------------------------
+
+    // Run until the cycle counter reaches `until` (instruction cycles, Fosc/4).
+    void runUntil(uint64_t until) {
+        while (cycles < until) {
+            if (sleeping) {
+                // Nothing executes; jump to the next peripheral event.
+                uint64_t next = nextEvent < until ? nextEvent : until;
+                if (next > cycles) cycles = next;
+                if (cycles >= nextEvent) servicePeripherals();
+                if (wakeRequested()) {
+                    sleeping = false;
+                    checkInterrupt();
+                }
+                continue;
+            }
+
+            const Insn &in = decoded[pc];
+            pc = (pc + 1) & 0x1FFF;
+            int cyc = execute(in);
+
+            cycles += cyc;
+            instructions++;
+
+            if (tmr0Internal) {
+                prescaleCount += cyc;
+                if (prescaleCount >= tmr0Period) tickTimer0();
+            }
+            if (cycles >= nextEvent) servicePeripherals();
+            if (ram[INTCON] & (1 << GIE)) checkInterrupt();
+        }
+    }
+
+    void runCycles(uint64_t n) { runUntil(cycles + n); }
+
+private:
+    // -----------------------------------------------------------------------
+    // Pre-decoded instruction form
+    // -----------------------------------------------------------------------
+    enum Op : uint8_t {
+        ADDWF, ANDWF, CLRF, CLRW, COMF, DECF, DECFSZ, INCF, INCFSZ, IORWF,
+        MOVF, MOVWF, NOP, RLF, RRF, SUBWF, SWAPF, XORWF,
+        BCF, BSF, BTFSC, BTFSS,
+        ADDLW, ANDLW, CALL, CLRWDT, GOTO, IORLW, MOVLW, RETFIE, RETLW,
+        RETURN, SLEEP, SUBLW, XORLW
+    };
+
+    struct Insn {
+        Op op;
+        uint8_t d;      // destination: 1 = f, 0 = W
+        uint8_t bit;    // bit-oriented ops: mask (1 << b)
+        uint16_t arg;   // file register, literal or branch target
+    };
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    static Insn decode(uint16_t word) {
+        Insn in = {NOP, 0, 0, 0};
+        uint8_t f = word & 0x7F;
+        uint8_t d = (word >> 7) & 1;
+
+        switch (word >> 12) {
+        case 0: {
+            uint8_t sub = (word >> 8) & 0x0F;
+            static const Op byteOps[16] = {
+                MOVWF, CLRF, SUBWF, DECF, IORWF, ANDWF, XORWF, ADDWF,
+                MOVF, COMF, INCF, DECFSZ, RRF, RLF, SWAPF, INCFSZ
+            };
+            if (sub == 0) {
+                if (d) { in.op = MOVWF; in.arg = f; }
+                else if (word == 0x0008) in.op = RETURN;
+                else if (word == 0x0009) in.op = RETFIE;
+                else if (word == 0x0063) in.op = SLEEP;
+                else if (word == 0x0064) in.op = CLRWDT;
+                else in.op = NOP;
+            } else if (sub == 1) {
+                in.op = d ? CLRF : CLRW;
+                in.arg = f;
+            } else {
+                in.op = byteOps[sub];
+                in.d = d;
+                in.arg = f;
+            }
+            break;
+        }
+        case 1: {
+            static const Op bitOps[4] = {BCF, BSF, BTFSC, BTFSS};
+            in.op = bitOps[(word >> 10) & 3];
+            in.bit = (uint8_t)(1 << ((word >> 7) & 7));
+            in.arg = f;
+            break;
+        }
+        case 2:
+            in.op = (word & 0x0800) ? GOTO : CALL;
+            in.arg = word & 0x07FF;
+            break;
+        case 3: {
+            uint8_t k = word & 0xFF;
+            in.arg = k;
+            switch ((word >> 8) & 0x0F) {
+            case 0x0: case 0x1: case 0x2: case 0x3: in.op = MOVLW; break;
+            case 0x4: case 0x5: case 0x6: case 0x7: in.op = RETLW; break;
+            case 0x8: in.op = IORLW; break;
+            case 0x9: in.op = ANDLW; break;
+            case 0xA: in.op = XORLW; break;
+            case 0xC: case 0xD: in.op = SUBLW; break;
+            case 0xE: case 0xF: in.op = ADDLW; break;
+            default: in.op = NOP; break;
+            }
+            break;
+        }
+        }
+        return in;
+    }
+
+    // -----------------------------------------------------------------------
+    // Register file
+    // -----------------------------------------------------------------------
+
+    // Every (bank, offset) pair resolved to one canonical slot, so mirrored
+    // SFRs and the shared 0x70-0x7F block need no special casing at runtime.
+    void buildBankMap() {
+        memset(hooks, 0, sizeof(hooks));
+        for (int bank = 0; bank < 4; bank++) {
+            for (int o = 0; o < 0x80; o++) {
+                int addr = bank * 0x80 + o;
+                int phys = addr;
+                if (o == INDF || o == PCL || o == STATUS || o == FSR ||
+                    o == PCLATH || o == INTCON || o >= 0x70) {
+                    phys = o;
+                } else if (o == TMR0 || o == PORTB) {
+                    phys = (bank & 1) ? 0x80 + o : o;   // TMR0/OPTION, PORTB/TRISB
+                }
+                bankMap[addr] = (uint16_t)phys;
+            }
+        }
+        // Registers whose access has side effects take the slow path.
+        const int hooked[] = {INDF, TMR0, PCL, PORTA, PORTB, PORTC, PORTD, PORTE,
+                              PIR1, TXREG, RCREG, ADCON0, OPTION_REG, TXSTA, RCSTA};
+        for (int r : hooked) hooks[r] = 1;
+    }
+
+    uint16_t resolve(uint8_t f) const {
+        if (f == INDF) return bankMap[((ram[STATUS] >> IRP) & 1) << 8 | ram[FSR]];
+        return bankMap[((ram[STATUS] >> RP0) & 3) << 7 | f];
+    }
+
+    uint8_t readF(uint8_t f) {
+        uint16_t a = resolve(f);
+        if (!hooks[a]) return ram[a];
+        return readSpecial(a);
+    }
+
+    void writeF(uint8_t f, uint8_t v) {
+        uint16_t a = resolve(f);
+        if (!hooks[a]) { ram[a] = v; return; }
+        writeSpecial(a, v);
+    }
+
+    uint8_t readSpecial(uint16_t a) {
+        switch (a) {
+        case INDF: return 0;            // INDF through INDF reads 0
+        case PCL: return pc & 0xFF;
+        case PORTA: case PORTB: case PORTC: case PORTD: case PORTE:
+            return getPort(a - PORTA);
+        case RCREG: {
+            uint8_t b = 0;
+            if (!rxFifo.empty()) {
+                b = rxFifo.front();
+                rxFifo.pop_front();
+            }
+            if (rxFifo.empty()) ram[PIR1] &= ~(1 << RCIF);
+            return b;
+        }
+        default: return ram[a];
+        }
+    }
+
+    void writeSpecial(uint16_t a, uint8_t v) {
+        switch (a) {
+        case INDF: return;
+        case PCL:
+            pc = ((ram[PCLATH] & 0x1F) << 8 | v) & 0x1FFF;
+            pclWritten = true;
+            return;
+        case TMR0:
+            ram[TMR0] = v;
+            prescaleCount = 0;
+            return;
+        case OPTION_REG:
+            ram[OPTION_REG] = v;
+            updateTimer0Config();
+            return;
+        case PORTA: case PORTB: case PORTC: case PORTD: case PORTE:
+            latch[a - PORTA] = v;
+            ram[a] = v;
+            return;
+        case PIR1:
+            // RCIF/TXIF are read-only, driven by the USART.
+            ram[PIR1] = (v & ~((1 << RCIF) | (1 << TXIF))) |
+                        (ram[PIR1] & ((1 << RCIF) | (1 << TXIF)));
+            return;
+        case TXREG:
+            ram[TXREG] = v;
+            txPending = true;
+            ram[PIR1] &= ~(1 << TXIF);
+            startTransmit();
+            return;
+        case TXSTA:
+            ram[TXSTA] = (v & ~(1 << TRMT)) | (ram[TXSTA] & (1 << TRMT));
+            startTransmit();
+            return;
+        case RCSTA:
+            ram[RCSTA] = v;
+            if (!(v & (1 << CREN))) ram[RCSTA] &= ~(1 << OERR);
+            scheduleNext();
+            return;
+        case ADCON0: {
+            bool start = (v & (1 << GO)) && !(ram[ADCON0] & (1 << GO));
+            ram[ADCON0] = v;
+            if (start && (v & (1 << ADON))) {
+                adcBusy = true;
+                adcDoneAt = cycles + adcCycles();
+                scheduleNext();
+            } else if (!(v & (1 << GO))) {
+                adcBusy = false;
+                scheduleNext();
+            }
+            return;
+        }
+        default:
+            ram[a] = v;
+        }
+    }
+
+    // -----------------------------------------------------------------------
+    // Core
+    // -----------------------------------------------------------------------
+
+    void setZ(uint8_t r) {
+        if (r) ram[STATUS] &= ~(1 << Z);
+        else ram[STATUS] |= (1 << Z);
+    }
+
+    void setFlag(int bit, bool on) {
+        if (on) ram[STATUS] |= (1 << bit);
+        else ram[STATUS] &= ~(1 << bit);
+    }
+
+    void store(const Insn &in, uint8_t r) {
+        if (in.d) writeF((uint8_t)in.arg, r);
+        else w = r;
+    }
+
+    uint8_t add(uint8_t a, uint8_t b) {
+        unsigned r = a + b;
+        setFlag(C, r > 0xFF);
+        setFlag(DC, ((a & 0x0F) + (b & 0x0F)) > 0x0F);
+        setZ((uint8_t)r);
+        return (uint8_t)r;
+    }
+
+    // a - b, C/DC are "no borrow" as on the PIC.
+    uint8_t sub(uint8_t a, uint8_t b) {
+        uint8_t r = a - b;
+        setFlag(C, a >= b);
+        setFlag(DC, (a & 0x0F) >= (b & 0x0F));
+        setZ(r);
+        return r;
+    }
+
+    void push(uint16_t addr) {
+        stack[sp] = addr;
+        sp = (sp + 1) & 7;
+    }
+
+    uint16_t pop() {
+        sp = (sp - 1) & 7;
+        return stack[sp];
+    }
+
+    // Returns instruction cycles consumed (1 or 2).
+    int execute(const Insn &in) {
+        uint8_t f = (uint8_t)in.arg;
+        uint8_t v, r;
+
+        switch (in.op) {
+        case ADDWF: store(in, add(readF(f), w)); break;
+        case ANDWF: r = readF(f) & w; setZ(r); store(in, r); break;
+        case CLRF: writeF(f, 0); setZ(0); break;
+        case CLRW: w = 0; setZ(0); break;
+        case COMF: r = ~readF(f); setZ(r); store(in, r); break;
+        case DECF: r = readF(f) - 1; setZ(r); store(in, r); break;
+        case INCF: r = readF(f) + 1; setZ(r); store(in, r); break;
+        case IORWF: r = readF(f) | w; setZ(r); store(in, r); break;
+        case MOVF: r = readF(f); setZ(r); store(in, r); break;
+        case MOVWF: writeF(f, w); break;
+        case SUBWF: store(in, sub(readF(f), w)); break;
+        case SWAPF: v = readF(f); store(in, (uint8_t)(v << 4 | v >> 4)); break;
+        case XORWF: r = readF(f) ^ w; setZ(r); store(in, r); break;
+        case RLF:
+            v = readF(f);
+            r = (uint8_t)(v << 1 | (ram[STATUS] & 1));
+            setFlag(C, v & 0x80);
+            store(in, r);
+            break;
+        case RRF:
+            v = readF(f);
+            r = (uint8_t)(v >> 1 | (ram[STATUS] & 1) << 7);
+            setFlag(C, v & 0x01);
+            store(in, r);
+            break;
+        case DECFSZ:
+            r = readF(f) - 1;
+            store(in, r);
+            if (r == 0) { pc = (pc + 1) & 0x1FFF; return 2; }
+            break;
+        case INCFSZ:
+            r = readF(f) + 1;
+            store(in, r);
+            if (r == 0) { pc = (pc + 1) & 0x1FFF; return 2; }
+            break;
+        case NOP: break;
+
+        case BCF: writeF(f, readF(f) & ~in.bit); break;
+        case BSF: writeF(f, readF(f) | in.bit); break;
+        case BTFSC:
+            if (!(readF(f) & in.bit)) { pc = (pc + 1) & 0x1FFF; return 2; }
+            break;
+        case BTFSS:
+            if (readF(f) & in.bit) { pc = (pc + 1) & 0x1FFF; return 2; }
+            break;
+
+        case ADDLW: w = add((uint8_t)in.arg, w); break;
+        case ANDLW: w &= in.arg; setZ(w); break;
+        case IORLW: w |= in.arg; setZ(w); break;
+        case XORLW: w ^= in.arg; setZ(w); break;
+        case SUBLW: w = sub((uint8_t)in.arg, w); break;
+        case MOVLW: w = (uint8_t)in.arg; break;
+        case CALL:
+            push(pc);
+            pc = (ram[PCLATH] & 0x18) << 8 | in.arg;
+            return 2;
+        case GOTO:
+            pc = (ram[PCLATH] & 0x18) << 8 | in.arg;
+            return 2;
+        case RETURN: pc = pop(); return 2;
+        case RETLW: w = (uint8_t)in.arg; pc = pop(); return 2;
+        case RETFIE:
+            pc = pop();
+            ram[INTCON] |= (1 << GIE);
+            return 2;
+        case CLRWDT: ram[STATUS] |= (1 << TO) | (1 << PD); break;
+        case SLEEP:
+            ram[STATUS] = (ram[STATUS] | (1 << TO)) & ~(1 << PD);
+            sleeping = true;
+            break;
+        }
+
+        if (pclWritten) {
+            pclWritten = false;
+            return 2;
+        }
+        return 1;
+    }
+
+    // -----------------------------------------------------------------------
+    // Interrupts
+    // -----------------------------------------------------------------------
+
+    bool pendingInterrupt() const {
+        uint8_t intcon = ram[INTCON];
+        if ((intcon & (1 << T0IE)) && (intcon & (1 << T0IF))) return true;
+        if ((intcon & 0x18) & ((intcon & 0x03) << 3)) return true;  // INT, RB
+        if ((intcon & (1 << PEIE)) && (ram[PIE1] & ram[PIR1])) return true;
+        return false;
+    }
+
+    bool wakeRequested() const {
+        // Peripheral flags wake the core from SLEEP regardless of GIE.
+        return pendingInterrupt();
+    }
+
+    void checkInterrupt() {
+        if (!(ram[INTCON] & (1 << GIE)) || !pendingInterrupt()) return;
+        push(pc);
+        ram[INTCON] &= ~(1 << GIE);
+        pc = 0x0004;
+        cycles += 2;
+    }
+
+    // -----------------------------------------------------------------------
+    // Timer0
+    // -----------------------------------------------------------------------
+
+    void updateTimer0Config() {
+        uint8_t opt = ram[OPTION_REG];
+        tmr0Internal = !(opt & 0x20);                       // T0CS
+        tmr0Period = (opt & 0x08) ? 1 : 2u << (opt & 0x07); // PSA, PS2:PS0
+    }
+
+    void tickTimer0() {
+        while (prescaleCount >= tmr0Period) {
+            prescaleCount -= tmr0Period;
+            if (++ram[TMR0] == 0) ram[INTCON] |= (1 << T0IF);
+        }
+    }
+
+    // -----------------------------------------------------------------------
+    // Peripherals on absolute-cycle deadlines (ADC, USART)
+    // -----------------------------------------------------------------------
+
+    // One UART character (start + 8 data + stop) in instruction cycles.
+    uint64_t charCycles() const {
+        uint64_t perBit = (ram[TXSTA] & (1 << BRGH) ? 4 : 16) * (uint64_t)(ram[SPBRG] + 1);
+        return perBit * 10;
+    }
+
+    // 12 TAD; TAD selected by ADCS2 (ADCON1<6>) : ADCS1:ADCS0 (ADCON0<7:6>).
+    uint64_t adcCycles() const {
+        int adcs = ram[ADCON0] >> 6;
+        if (adcs == 3) return 12 * 4;                   // internal RC, ~4 us at 4 MHz
+        uint64_t toscPerTad = 2u << (adcs * 2);         // 2, 8, 32 Tosc
+        if (ram[ADCON1] & 0x40) toscPerTad *= 2;
+        uint64_t c = 12 * toscPerTad / 4;
+        return c ? c : 1;
+    }
+
+    void startTransmit() {
+        if (txBusy || !txPending || !(ram[TXSTA] & (1 << TXEN))) return;
+        txShift = ram[TXREG];
+        txPending = false;
+        txBusy = true;
+        txDoneAt = cycles + charCycles();
+        ram[TXSTA] &= ~(1 << TRMT);
+        ram[PIR1] |= (1 << TXIF);
+        scheduleNext();
+    }
+
+    void scheduleNext() {
+        nextEvent = UINT64_MAX;
+        if (adcBusy && adcDoneAt < nextEvent) nextEvent = adcDoneAt;
+        if (txBusy && txDoneAt < nextEvent) nextEvent = txDoneAt;
+        if (!rxLine.empty() && rxEnabled() && rxNextAt < nextEvent) nextEvent = rxNextAt;
+    }
+
+    bool rxEnabled() const {
+        return (ram[RCSTA] & (1 << SPEN)) && (ram[RCSTA] & (1 << CREN));
+    }
+
+    void servicePeripherals() {
+        if (adcBusy && cycles >= adcDoneAt) {
+            adcBusy = false;
+            int ch = (ram[ADCON0] >> 3) & 7;
+            uint16_t v = analogIn[ch];
+            if (ram[ADCON1] & 0x80) {               // ADFM: right justified
+                ram[ADRESH] = v >> 8;
+                ram[ADRESL] = v & 0xFF;
+            } else {
+                ram[ADRESH] = v >> 2;
+                ram[ADRESL] = (v & 3) << 6;
+            }
+            ram[ADCON0] &= ~(1 << GO);
+            ram[PIR1] |= (1 << ADIF);
+        }
+
+        if (txBusy && cycles >= txDoneAt) {
+            txLine.push_back(txShift);
+            txBusy = false;
+            ram[TXSTA] |= (1 << TRMT);
+            startTransmit();
+        }
+
+        if (!rxLine.empty() && rxEnabled() && cycles >= rxNextAt) {
+            uint8_t b = rxLine.front();
+            rxLine.pop_front();
+            if (rxFifo.size() < 2) {
+                rxFifo.push_back(b);
+                ram[PIR1] |= (1 << RCIF);
+            } else {
+                ram[RCSTA] |= (1 << OERR);
+            }
+            rxNextAt = cycles + charCycles();
+        }
+
+        scheduleNext();
+    }
+
+    // --- State ---
+    uint32_t fosc;
+    uint16_t program[PROGRAM_WORDS];
+    Insn decoded[PROGRAM_WORDS];
+    uint16_t bankMap[RAM_SIZE];
+    uint8_t hooks[RAM_SIZE];
+    uint8_t ram[RAM_SIZE];
+    uint8_t latch[5];
+    uint8_t pinIn[5];
+    uint16_t analogIn[8];
+
+    uint8_t w;
+    uint16_t pc;
+    uint16_t stack[8];
+    uint8_t sp;
+    bool sleeping;
+    bool pclWritten = false;
+    uint64_t cycles;
+    uint64_t instructions;
+
+    bool tmr0Internal;
+    uint32_t tmr0Period;
+    uint32_t prescaleCount;
+
+    bool adcBusy;
+    uint64_t adcDoneAt;
+
+    bool txBusy, txPending;
+    uint8_t txShift = 0;
+    uint64_t txDoneAt;
+    std::deque<uint8_t> txLine;      // bytes fully shifted out, waiting for the host
+
+    std::deque<uint8_t> rxLine;      // bytes from the host, not yet shifted in
+    std::deque<uint8_t> rxFifo;      // 2-deep RCREG FIFO
+    uint64_t rxNextAt;
+
+    uint64_t nextEvent;
+};
+
+#endif